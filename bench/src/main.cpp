@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <boa/boa.h>
+
+// Headless triangulation benchmark. Every generated polygon is triangulated,
+// timed and checked: the triangles must tile the polygon exactly.
+// Usage: boa_bench [max vertices, default 10^6]
+
+// Heap accounting through the global allocation functions. The benchmark is
+// single-threaded, so plain counters are enough.
+namespace {
+
+const std::size_t HEADER = 16; // Keeps the returned block 16-byte aligned
+
+std::size_t num_allocations = 0;
+std::size_t heap_bytes = 0;
+std::size_t peak_heap_bytes = 0;
+
+} // namespace
+
+void *operator new(std::size_t size) {
+	void *block = std::malloc(size + HEADER);
+	if(block == nullptr) throw std::bad_alloc();
+
+	*static_cast<std::size_t*>(block) = size;
+	++num_allocations;
+	heap_bytes += size;
+	peak_heap_bytes = std::max(peak_heap_bytes, heap_bytes);
+	return static_cast<char*>(block) + HEADER;
+}
+
+void operator delete(void *pointer) noexcept {
+	if(pointer == nullptr) return;
+
+	char *block = static_cast<char*>(pointer) - HEADER;
+	heap_bytes -= *reinterpret_cast<std::size_t*>(block);
+	std::free(block);
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete[](void *pointer) noexcept { operator delete(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { operator delete(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { operator delete(pointer); }
+
+namespace {
+
+// Polygon generators. Sizes scale with the vertex count so neighbouring
+// vertices stay well apart once rounded to GLfloat positions.
+boa::Vertices convex(const int n) {
+	const double radius = std::max(100.0, (double) n);
+	boa::Vertices ring;
+	for(int i = 0; i < n; ++i) {
+		const double angle = 2 * boa::PI * i / n;
+		ring.push_back(glm::vec4(radius * std::cos(angle), radius * std::sin(angle), 0.0f, 0.0f));
+	}
+	return ring;
+}
+
+boa::Vertices star(const int n) {
+	const double radius = std::max(100.0, (double) n);
+	boa::Vertices ring;
+	for(int i = 0; i < n; ++i) {
+		const double angle = 2 * boa::PI * i / n;
+		const double r = i % 2 == 0 ? radius : radius * 0.4;
+		ring.push_back(glm::vec4(r * std::cos(angle), r * std::sin(angle), 0.0f, 0.0f));
+	}
+	return ring;
+}
+
+// Teeth hanging down from a bar, every tooth its own monotone piece
+boa::Vertices comb(const int n) {
+	const int teeth = std::max(1, n / 4);
+	boa::Vertices ring;
+	ring.push_back(glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
+	ring.push_back(glm::vec4(teeth * 2.0f, 0.0f, 0.0f, 0.0f));
+	for(int t = teeth - 1; t >= 0; --t) {
+		ring.push_back(glm::vec4(2.0f * t + 2.0f, -10.0f, 0.0f, 0.0f));
+		ring.push_back(glm::vec4(2.0f * t + 1.0f, -10.0f, 0.0f, 0.0f));
+		if(t > 0) {
+			ring.push_back(glm::vec4(2.0f * t + 1.0f, -1.0f, 0.0f, 0.0f));
+			ring.push_back(glm::vec4(2.0f * t + 0.5f, -1.0f, 0.0f, 0.0f));
+		}
+	}
+	return ring;
+}
+
+// A band wound outwards, stepping a fixed arc length so turns stay apart
+boa::Vertices spiral(const int n) {
+	const int half = std::max(2, n / 2);
+	boa::Vertices outer, inner;
+	double angle = 0.0;
+	for(int i = 0; i < half; ++i) {
+		const double radius = 10.0 + 3.0 * angle;
+		outer.push_back(glm::vec4(radius * std::cos(angle), radius * std::sin(angle), 0.0f, 0.0f));
+		inner.push_back(glm::vec4((radius - 6.0) * std::cos(angle), (radius - 6.0) * std::sin(angle), 0.0f, 0.0f));
+		angle += 0.5 / radius;
+	}
+
+	boa::Vertices ring(outer);
+	ring.insert(ring.end(), inner.rbegin(), inner.rend());
+	return ring;
+}
+
+// Star-shaped around the origin with random radii, and angles jittered
+// within their slots so they stay sorted
+boa::Vertices random_simple(const int n) {
+	const double radius = std::max(100.0, (double) n);
+	std::mt19937 generator(n);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	boa::Vertices ring;
+	for(int i = 0; i < n; ++i) {
+		const double angle = 2 * boa::PI * (i + 0.8 * unit(generator)) / n;
+		const double r = radius * (0.2 + 0.8 * unit(generator));
+		ring.push_back(glm::vec4(r * std::cos(angle), r * std::sin(angle), 0.0f, 0.0f));
+	}
+	return ring;
+}
+
+// Rings to triangulate together, and which of them the generator made holes
+struct Shape {
+	std::vector<boa::Vertices> rings;
+	std::vector<bool> holes;
+};
+
+// A square outline with a grid of square holes, wound both ways
+Shape holes(const int n) {
+	const int grid = std::max(1, (int) std::sqrt((n - 4) / 4.0));
+	const float cell = 10.0f;
+	Shape shape;
+	shape.rings.push_back({
+		glm::vec4(0.0f, 0.0f, 0.0f, 0.0f),
+		glm::vec4(grid * cell, 0.0f, 0.0f, 0.0f),
+		glm::vec4(grid * cell, grid * cell, 0.0f, 0.0f),
+		glm::vec4(0.0f, grid * cell, 0.0f, 0.0f)
+	});
+	shape.holes.push_back(false);
+	for(int i = 0; i < grid; ++i) {
+		for(int j = 0; j < grid; ++j) {
+			const float x = i * cell + 2.0f, y = j * cell + 2.0f + i % 3;
+			boa::Vertices hole = {
+				glm::vec4(x, y, 0.0f, 0.0f),
+				glm::vec4(x + 5.0f, y, 0.0f, 0.0f),
+				glm::vec4(x + 5.0f, y + 5.0f, 0.0f, 0.0f),
+				glm::vec4(x, y + 5.0f, 0.0f, 0.0f)
+			};
+			if((i + j) % 2 == 0) std::reverse(hole.begin(), hole.end());
+			shape.rings.push_back(hole);
+			shape.holes.push_back(true);
+		}
+	}
+	return shape;
+}
+
+template<boa::Vertices (*generate)(const int n)> Shape single(const int n) {
+	return {{generate(n)}, {false}};
+}
+
+struct Generator {
+	const char *name;
+	Shape (*generate)(const int n);
+};
+
+const char *path_name(const boa::TriangulationPath path) {
+	switch(path) {
+	case boa::TriangulationPath::CONVEX_FAN: return "fan";
+	case boa::TriangulationPath::MONOTONE: return "monotone";
+	default: return "partitioned";
+	}
+}
+
+double elapsed_ns(const std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Result {
+	int num_verts;
+	boa::TriangulationPath path;
+	double partition_ns; // Per vertex, GLData::split()
+	double triangulate_ns; // Per vertex, GLData::triangulate_partitions()
+	double total_ns; // Per vertex, the whole of gen_gl_data
+	std::size_t cold_allocations; // Constructing a GLData
+	std::size_t steady_allocations; // Triangulating it again
+	std::size_t peak_bytes; // Heap high water mark while constructing
+	bool valid;
+};
+
+std::uint64_t edge_key(const GLuint from, const GLuint to) {
+	return static_cast<std::uint64_t>(from) << 32 | to;
+}
+
+// GLData agrees with the generator on which rings are holes, and its
+// triangles tile the polygon: they all have the same winding (or none, if
+// degenerate), every ring edge belongs to exactly one triangle, running the
+// way that winding puts the polygon's inside, and every other edge is shared
+// by exactly two triangles running opposite ways. Their areas must also add
+// up to the outlines' less the holes'. Float differences and their products
+// are exact in long double, so only the sums round.
+bool covers(boa::GLData &data, const std::vector<bool> &holes) {
+	const int n = data.get_num_verts();
+	const int stride = data.get_stride();
+	const GLfloat *positions = data.get_vertices();
+	const GLuint *indices = data.get_indices();
+
+	int num_triangles = n;
+	if(data.get_num_rings() != (int) holes.size()) return false;
+	for(int k = 0; k < data.get_num_rings(); ++k) {
+		if(holes[k] != data.is_hole(k)) return false;
+		num_triangles += holes[k] ? 2 : -2;
+	}
+	if(data.get_num_elements() != num_triangles * 3) return false;
+
+	long double triangles_area = 0.0L;
+	int winding = 0;
+	std::vector<std::uint64_t> edges;
+	for(int t = 0; t < data.get_num_elements(); t += 3) {
+		if(indices[t] >= (GLuint) n || indices[t + 1] >= (GLuint) n || indices[t + 2] >= (GLuint) n) return false;
+
+		const GLfloat *a = &positions[indices[t] * stride];
+		const GLfloat *b = &positions[indices[t + 1] * stride];
+		const GLfloat *c = &positions[indices[t + 2] * stride];
+		const double orientation = boa::orient2d(a, b, c);
+		if(orientation != 0.0) {
+			const int sign = orientation > 0.0 ? 1 : -1;
+			if(winding == 0) winding = sign;
+			else if(sign != winding) return false;
+		}
+
+		const long double area = ((long double) b[0] - a[0]) * ((long double) c[1] - a[1])
+			- ((long double) b[1] - a[1]) * ((long double) c[0] - a[0]);
+		triangles_area += std::fabs(area) / 2;
+
+		for(int e = 0; e < 3; ++e) edges.push_back(edge_key(indices[t + e], indices[t + (e + 1) % 3]));
+	}
+	std::sort(edges.begin(), edges.end());
+	if(std::adjacent_find(edges.begin(), edges.end()) != edges.end()) return false; // Overlapping triangles
+
+	// Ring edges as the triangles must run them: the way the ring is wound if
+	// that matches the triangles' winding, reversed if not, and the other way
+	// again for holes
+	long double polygon_area = 0.0L;
+	long double magnitude = 0.0L;
+	std::vector<std::uint64_t> ring_edges;
+	for(int k = 0; k < data.get_num_rings(); ++k) {
+		const int start = data.get_ring_start(k);
+		const int end = data.get_ring_start(k + 1);
+
+		long double ring_area = 0.0L;
+		for(int i = start, j = end - 1; i < end; j = i++) {
+			const long double term = (long double) positions[j * stride] * positions[i * stride + 1]
+				- (long double) positions[i * stride] * positions[j * stride + 1];
+			ring_area += term;
+			magnitude += std::fabs(term);
+		}
+		polygon_area += holes[k] ? -std::fabs(ring_area) / 2 : std::fabs(ring_area) / 2;
+
+		const bool along = ((ring_area > 0.0L) == (winding > 0)) != holes[k];
+		for(int i = start, j = end - 1; i < end; j = i++) ring_edges.push_back(along ? edge_key(j, i) : edge_key(i, j));
+	}
+	std::sort(ring_edges.begin(), ring_edges.end());
+
+	std::size_t num_ring_edges = 0;
+	for(const std::uint64_t edge : edges) {
+		const std::uint64_t reverse = edge_key(edge & 0xFFFFFFFF, edge >> 32);
+		if(std::binary_search(ring_edges.begin(), ring_edges.end(), edge)) ++num_ring_edges;
+		else if(std::binary_search(ring_edges.begin(), ring_edges.end(), reverse)) return false; // Ring edge run the wrong way
+		else if(!std::binary_search(edges.begin(), edges.end(), reverse)) return false; // Unshared interior edge
+	}
+	if(num_ring_edges != ring_edges.size()) return false;
+
+	return std::fabs(triangles_area - polygon_area) <= 1e-9L * std::max(magnitude, 1.0L);
+}
+
+// Time each triangulation stage, keeping the fastest of several repetitions
+Result run(const Shape &shape, const int repetitions) {
+	Result result;
+	result.partition_ns = 1e300;
+	result.triangulate_ns = 1e300;
+	result.total_ns = 1e300;
+
+	const std::size_t baseline_bytes = heap_bytes;
+	const std::size_t baseline_allocations = num_allocations;
+	peak_heap_bytes = heap_bytes;
+	boa::GLData data(shape.rings, 3);
+	result.cold_allocations = num_allocations - baseline_allocations;
+	result.peak_bytes = peak_heap_bytes - baseline_bytes;
+	result.num_verts = data.get_num_verts();
+	result.path = data.get_triangulation_path();
+
+	for(int r = 0; r < repetitions; ++r) {
+		const std::size_t allocations = num_allocations;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		data.split();
+		result.partition_ns = std::min(result.partition_ns, elapsed_ns(start));
+
+		start = std::chrono::steady_clock::now();
+		data.triangulate_partitions();
+		result.triangulate_ns = std::min(result.triangulate_ns, elapsed_ns(start));
+		result.steady_allocations = num_allocations - allocations;
+
+		start = std::chrono::steady_clock::now();
+		data.gen_gl_data(shape.rings);
+		result.total_ns = std::min(result.total_ns, elapsed_ns(start));
+	}
+
+	result.partition_ns /= result.num_verts;
+	result.triangulate_ns /= result.num_verts;
+	result.total_ns /= result.num_verts;
+	result.valid = covers(data, shape.holes);
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	const int max_verts = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	const Generator generators[] = {
+		{"convex", single<convex>},
+		{"star", single<star>},
+		{"comb", single<comb>},
+		{"spiral", single<spiral>},
+		{"random", single<random_simple>},
+		{"holes", holes}
+	};
+
+	std::printf("%-8s %8s %-12s %12s %12s %12s %8s %8s %10s  %s\n", "polygon", "verts", "path",
+		"part ns/v", "tri ns/v", "total ns/v", "allocs", "steady", "peak KiB", "coverage");
+
+	int failures = 0;
+	for(const Generator &generator : generators) {
+		for(int n = 10; n <= max_verts; n *= 10) {
+			const Shape shape = generator.generate(n);
+			const int repetitions = std::max(2, std::min(200, 2000000 / n));
+			const Result result = run(shape, repetitions);
+			if(!result.valid) ++failures;
+
+			std::printf("%-8s %8d %-12s %12.1f %12.1f %12.1f %8zu %8zu %10.1f  %s\n", generator.name, result.num_verts,
+				path_name(result.path), result.partition_ns, result.triangulate_ns, result.total_ns,
+				result.cold_allocations, result.steady_allocations, result.peak_bytes / 1024.0, result.valid ? "ok" : "FAIL");
+			std::fflush(stdout);
+		}
+	}
+
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	std::printf("\nPeak resident set: %.1f MiB\n", usage.ru_maxrss / 1024.0);
+
+	if(failures > 0) {
+		std::printf("%d polygons were not covered exactly\n", failures);
+		return 1;
+	}
+	return 0;
+}
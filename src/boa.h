@@ -14,6 +14,31 @@
 
 #include "boa_global.h"
 #include "boa_fns.h"
+#include "command_buffer.h"
 #include "gl_data.h"
+#include "gl_batch.h"
+#include "gl_state.h"
+#include "headless_context.h"
+#include "hot_reloader.h"
+#include "instanced_mesh.h"
+#include "mesh.h"
+#include "mapped_file.h"
+#include "mesh_batcher.h"
+#include "mesh_file.h"
+#include "predicates.h"
+#include "profiler.h"
+#include "program.h"
+#include "program_builder.h"
+#include "program_cache.h"
+#include "readback_ring.h"
+#include "render_target.h"
+#include "stream_buffer.h"
+#include "texture_atlas.h"
+#include "texture_file.h"
+#include "texture_loader.h"
+#include "thread_pool.h"
+#include "triangulation_cache.h"
+#include "vertex_format.h"
+#include "window.h"
 
 #endif // BOA_H
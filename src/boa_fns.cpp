@@ -1,40 +1,36 @@
 #include "boa_fns.h"
+#include "gl_state.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 namespace boa {
 
-bool init(GLint version_major, GLint version_minor, GLboolean resizable) {
-	// Initialize GLFW
-	glfwInit();
-
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version_major);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version_minor);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-	glfwWindowHint(GLFW_RESIZABLE, resizable);
+// Files
+std::string read_file(const char* path) {
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if(!file.is_open()) {
+		ERROR("File " << path << " could not be opened");
+		return "";
+	}
 
-	glewExperimental = GL_TRUE;
+	// Size the string once and read everything in one call
+	file.seekg(0, std::ios::end);
+	std::string contents(file.tellg(), '\0');
+	file.seekg(0, std::ios::beg);
+	file.read(&contents[0], contents.size());
 
-	return true; // TODO: Should return false if initialization fails
+	return contents;
 }
 
 
 // Shaders
 GLuint compile_shader(const char* source, GLenum type) {
-	std::ifstream shader_file;
-	shader_file.open(source, std::ios::in);
-	std::string shader_source;
-	if(shader_file.is_open()) {
-		std::string line = "";
-		while(std::getline(shader_file, line)) {
-			shader_source += line + "\n";
-		}
-
-		shader_file.close();
-	}
+	return compile_shader_source(read_file(source), type, source);
+}
 
-	const char* shader_c_str = shader_source.c_str();
+GLuint compile_shader_source(const std::string& source, GLenum type, const char* name) {
+	const char* shader_c_str = source.c_str();
 
 	GLuint shader = glCreateShader(type);
 	glShaderSource(shader, 1, &shader_c_str, NULL);
@@ -45,7 +41,7 @@ GLuint compile_shader(const char* source, GLenum type) {
 	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 	if(!success) {
 		glGetShaderInfoLog(shader, 512, NULL, info_log);
-		ERROR(source << ":" << info_log);
+		ERROR(name << ":" << info_log);
 
 		return -1;
 	}
@@ -60,6 +56,14 @@ GLuint create_program(std::initializer_list<GLuint> shaders) {
 	}
 	glLinkProgram(program);
 
+	GLint success;
+	GLchar info_log[512];
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if(!success) {
+		glGetProgramInfoLog(program, 512, NULL, info_log);
+		ERROR("Program failed to link:" << info_log);
+	}
+
 	return program;
 }
 
@@ -77,37 +81,39 @@ GLuint load_texture(const char* source) {
 		return texture;
 	}
 
-	glBindTexture(GL_TEXTURE_2D, texture);
-	//           Internal info                               External info
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+	GLint internal_format;
+	GLenum format;
+	get_texture_format(channels, internal_format, format);
+
+	gl_state().bind_texture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Rows of 1 to 3 channel images need not be 4-byte aligned
+	//           Internal info                                       External info
+	glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, image);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 	glGenerateMipmap(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	gl_state().bind_texture(GL_TEXTURE_2D, 0);
 
 	stbi_image_free(image);
 
 	return texture;
 }
 
-void set_texture(GLenum target, GLenum unit, GLuint texture) {
-	glActiveTexture(GL_TEXTURE0 + unit);
-	glBindTexture(target, texture);
-}
-
-
-// Windows
-GLFWwindow* create_window(int width, int height, std::string name, GLFWmonitor* monitor, GLFWwindow* share) {
-	GLFWwindow* window = glfwCreateWindow(width, height, name.c_str(), monitor, share);
-	if(window == nullptr) {
-		ERROR("Failed to create window \"" << name << "\"");
-	}
-
-	glfwMakeContextCurrent(window);
-
-	if(glewInit() != GLEW_OK) {
-		ERROR("Failed to initialize GLEW for window \"" << name << "\"");
+bool get_texture_format(int channels, GLint& internal_format, GLenum& format) {
+	switch(channels) {
+	case 1: internal_format = GL_R8; format = GL_RED; return true;
+	case 2: internal_format = GL_RG8; format = GL_RG; return true;
+	case 3: internal_format = GL_RGB8; format = GL_RGB; return true;
+	case 4: internal_format = GL_RGBA8; format = GL_RGBA; return true;
+	default:
+		ERROR("Images with " << channels << " channels are not supported");
+		internal_format = GL_RGBA8;
+		format = GL_RGBA;
+		return false;
 	}
+}
 
-	return window;
+void set_texture(GLenum target, GLenum unit, GLuint texture) {
+	gl_state().bind_texture(target, unit, texture);
 }
 
 } // boa
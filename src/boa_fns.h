@@ -7,7 +7,6 @@
 #include <string>
 
 #include <GL/glew.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -16,20 +15,19 @@
 
 namespace boa {
 
-// General
-bool init(GLint version_major, GLint version_minor, GLboolean resizable);
+// Files
+std::string read_file(const char* path);
 
 // Shaders
 GLuint compile_shader(const char* source, GLenum type);
+GLuint compile_shader_source(const std::string& source, GLenum type, const char* name = "");
 GLuint create_program(std::initializer_list<GLuint> shaders);
 
 // Textures
 GLuint load_texture(const char* source);
+bool get_texture_format(int channels, GLint& internal_format, GLenum& format); // Sized format for 1 to 4 channels
 void set_texture(GLenum target, GLenum unit, GLuint texture);
 
-// Windows
-GLFWwindow* create_window(int width, int height, std::string name, GLFWmonitor* monitor = nullptr, GLFWwindow* share = nullptr);
-
 } // boa
 
 #endif // BOA_FNS_H
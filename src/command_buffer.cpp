@@ -0,0 +1,144 @@
+#include "command_buffer.h"
+
+#include <cassert>
+#include <utility>
+
+#include "gl_state.h"
+#include "profiler.h"
+
+namespace boa {
+
+DrawPacket::DrawPacket(Program &program, Mesh &mesh, const glm::mat4 &model) {
+	this->program = &program;
+	this->mesh = &mesh;
+	texture = 0;
+	texture_target = GL_TEXTURE_2D;
+	this->model = model;
+	num_uniforms = 0;
+}
+
+DrawPacket &DrawPacket::set_texture(const GLuint texture, const GLenum target) {
+	this->texture = texture;
+	texture_target = target;
+	return *this;
+}
+
+DrawPacket &DrawPacket::set_uniform(const int slot, const glm::vec4 &value) {
+	assert(num_uniforms < MAX_PACKET_UNIFORMS);
+	uniform_slots[num_uniforms] = slot;
+	uniform_values[num_uniforms] = value;
+	++num_uniforms;
+	return *this;
+}
+
+std::atomic<unsigned> CommandBuffer::next_id(0);
+
+CommandBuffer::CommandBuffer() {
+	id = next_id++;
+}
+
+// The calling thread's stream, created the first time it records
+CommandBuffer::Stream &CommandBuffer::local_stream() {
+	static thread_local std::vector<std::pair<unsigned, Stream*>> cache;
+	for(const std::pair<unsigned, Stream*> &entry : cache) {
+		if(entry.first == id) return *entry.second;
+	}
+
+	std::lock_guard<std::mutex> lock(streams_mutex);
+	streams.emplace_back(new Stream());
+	cache.emplace_back(id, streams.back().get());
+	return *streams.back();
+}
+
+int CommandBuffer::add_uniform(const std::string &name) {
+	uniform_names.push_back(name);
+	return uniform_names.size() - 1;
+}
+
+void CommandBuffer::record(const std::uint64_t key, const DrawPacket &packet) {
+	Stream &stream = local_stream();
+	stream.keys.push_back(key);
+	stream.packets.push_back(packet);
+}
+
+// Stable least significant digit radix sort on the keys, a byte per pass.
+// Passes where every key has the same byte are skipped.
+void CommandBuffer::sort() {
+	scratch.resize(items.size());
+
+	for(int shift = 0; shift < 64; shift += 8) {
+		std::size_t counts[256] = {};
+		for(const SortItem &item : items) ++counts[item.key >> shift & 0xFF];
+		if(counts[items[0].key >> shift & 0xFF] == items.size()) continue;
+
+		std::size_t offset = 0;
+		for(std::size_t &count : counts) {
+			const std::size_t bucket = count;
+			count = offset;
+			offset += bucket;
+		}
+		for(const SortItem &item : items) scratch[counts[item.key >> shift & 0xFF]++] = item;
+		items.swap(scratch);
+	}
+}
+
+int CommandBuffer::execute() {
+	PROFILE_SCOPE("CommandBuffer::execute");
+	items.clear();
+	for(std::size_t s = 0; s < streams.size(); ++s) {
+		const std::vector<std::uint64_t> &keys = streams[s]->keys;
+		for(std::size_t p = 0; p < keys.size(); ++p) items.push_back({keys[p], (std::uint32_t) s, (std::uint32_t) p});
+	}
+	if(items.empty()) return 0;
+	sort();
+
+	// Program and texture binds go through the state cache, so runs of
+	// packets sharing them cost one bind. Uniform names are looked up once
+	// per run of packets with the same program.
+	Program *program = nullptr;
+	int model_index = -1;
+	for(const SortItem &item : items) {
+		const DrawPacket &packet = streams[item.stream]->packets[item.packet];
+		if(packet.program != program) {
+			program = packet.program;
+			model_index = program->uniform_index("model");
+			slot_indices.resize(uniform_names.size());
+			for(std::size_t i = 0; i < uniform_names.size(); ++i) slot_indices[i] = program->uniform_index(uniform_names[i]);
+		}
+
+		program->use();
+		if(packet.texture != 0) gl_state().bind_texture(packet.texture_target, 0, packet.texture);
+		program->set_uniform(model_index, packet.model);
+		for(int i = 0; i < packet.num_uniforms; ++i) {
+			program->set_uniform(slot_indices[packet.uniform_slots[i]], packet.uniform_values[i]);
+		}
+		packet.mesh->draw();
+	}
+
+	const int num_draws = items.size();
+	clear();
+	return num_draws;
+}
+
+// Streams keep their capacity, so steady frames record without allocating
+void CommandBuffer::clear() {
+	for(std::unique_ptr<Stream> &stream : streams) {
+		stream->keys.clear();
+		stream->packets.clear();
+	}
+}
+
+int CommandBuffer::get_num_packets() {
+	int num_packets = 0;
+	for(const std::unique_ptr<Stream> &stream : streams) num_packets += stream->keys.size();
+	return num_packets;
+}
+
+std::uint64_t CommandBuffer::make_key(const std::uint8_t layer, const GLuint program, const GLuint texture, const GLuint vertex_array) {
+	return static_cast<std::uint64_t>(layer) << 56
+		| static_cast<std::uint64_t>(program & 0xFFFF) << 40
+		| static_cast<std::uint64_t>(texture & 0xFFFF) << 24
+		| (vertex_array & 0xFFFFFF);
+}
+
+} // namespace boa
@@ -0,0 +1,99 @@
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "boa_global.h"
+#include "mesh.h"
+#include "program.h"
+
+namespace boa {
+
+const int MAX_PACKET_UNIFORMS = 4;
+
+// Everything needed to draw one mesh. Packets hold pointers, so the program
+// and mesh must outlive the frame they are recorded in.
+struct DrawPacket {
+	Program *program;
+	Mesh *mesh;
+	GLuint texture; // Bound to unit 0, or 0 to leave texture bindings alone
+	GLenum texture_target;
+	glm::mat4 model; // Set as the "model" uniform when the program has one
+
+	// Extra vec4 uniforms, by slot from CommandBuffer::add_uniform
+	int num_uniforms;
+	int uniform_slots[MAX_PACKET_UNIFORMS];
+	glm::vec4 uniform_values[MAX_PACKET_UNIFORMS];
+
+	DrawPacket(Program &program, Mesh &mesh, const glm::mat4 &model = glm::mat4());
+
+	DrawPacket &set_texture(const GLuint texture, const GLenum target = GL_TEXTURE_2D);
+	DrawPacket &set_uniform(const int slot, const glm::vec4 &value);
+};
+
+// Draw packets recorded from any number of threads and executed in key order
+// on the GL thread. Each recording thread appends to its own stream, so
+// recording takes no locks once a thread has recorded once. execute() merges
+// the streams, radix sorts them by key and draws them; recording for a frame
+// must be finished (e.g. ThreadPool::wait) before it is executed.
+class CommandBuffer {
+private:
+	struct Stream {
+		std::vector<std::uint64_t> keys;
+		std::vector<DrawPacket> packets;
+	};
+
+	struct SortItem {
+		std::uint64_t key;
+		std::uint32_t stream;
+		std::uint32_t packet;
+	};
+
+	static std::atomic<unsigned> next_id;
+
+	unsigned id; // Tells this buffer's streams apart in each thread's cache
+	std::mutex streams_mutex;
+	std::vector<std::unique_ptr<Stream>> streams;
+	std::vector<std::string> uniform_names;
+	std::vector<int> slot_indices; // Uniform index of each slot in the program being drawn
+	std::vector<SortItem> items;
+	std::vector<SortItem> scratch;
+
+	Stream &local_stream();
+	void sort();
+public:
+	CommandBuffer();
+	CommandBuffer(const CommandBuffer&) = delete;
+
+	CommandBuffer &operator=(const CommandBuffer&) = delete;
+
+	// Register a uniform name for DrawPacket::set_uniform, before recording
+	int add_uniform(const std::string &name);
+
+	// Record a packet from the calling thread
+	void record(const std::uint64_t key, const DrawPacket &packet);
+
+	// Sort and draw everything recorded, then clear. Returns the number of draws.
+	int execute();
+	void clear();
+
+	int get_num_packets();
+
+	// Key that groups draws by layer first, then program, texture and vertex
+	// array, so consecutive packets share as much state as possible. Names are
+	// truncated to the field widths (16, 16 and 24 bits).
+	static std::uint64_t make_key(const std::uint8_t layer, const GLuint program, const GLuint texture, const GLuint vertex_array);
+};
+
+} // namespace boa
+
+#endif // COMMAND_BUFFER_H
@@ -0,0 +1,76 @@
+#include "gl_batch.h"
+
+namespace boa {
+
+// Number of vertices each task should triangulate before handing off
+const int BATCH_GRAIN = 4096;
+
+GLBatch::GLBatch(const Vertices *rings, const int num_rings, const int stride, ThreadPool &pool, TriangulationCache *cache) {
+	num_attributes = stride;
+	gen_gl_data(rings, num_rings, pool, cache);
+}
+
+GLBatch::GLBatch(const std::vector<Vertices> &rings, const int stride, ThreadPool &pool, TriangulationCache *cache) {
+	num_attributes = stride;
+	gen_gl_data(rings.data(), rings.size(), pool, cache);
+}
+
+void GLBatch::gen_gl_data(const Vertices *rings, const int num_rings, ThreadPool &pool, TriangulationCache *cache) {
+	DEBUG_TITLE("BATCHING " << num_rings << " POLYGONS");
+
+	// Lay out every polygon's range so tasks never share memory
+	ranges.resize(num_rings);
+	paths.assign(num_rings, TriangulationPath::PARTITIONED);
+	int num_verts = 0;
+	int num_elements = 0;
+	for(int i = 0; i < num_rings; ++i) {
+		const int ring_verts = rings[i].size();
+		ranges[i].base_vertex = num_verts;
+		ranges[i].first_index = num_elements;
+		ranges[i].num_elements = ring_verts >= 3 ? (ring_verts - 2) * 3 : 0;
+
+		if(ring_verts < 3) ERROR("Polygon " << i << " has fewer than 3 vertices");
+
+		num_verts += ring_verts;
+		num_elements += ranges[i].num_elements;
+	}
+
+	vertices.assign(num_verts * num_attributes, 0.0f);
+	indices.assign(num_elements, 0);
+
+	// Split polygons into tasks of roughly BATCH_GRAIN vertices each
+	for(int first = 0; first < num_rings;) {
+		int last = first;
+		int task_verts = 0;
+		while(last < num_rings && (last == first || task_verts < BATCH_GRAIN)) {
+			task_verts += rings[last++].size();
+		}
+
+		pool.submit([this, rings, first, last, cache] {
+			for(int i = first; i < last; ++i) {
+				if(ranges[i].num_elements == 0) continue;
+
+				GLData polygon(&vertices[ranges[i].base_vertex * num_attributes], &indices[ranges[i].first_index], rings[i].size(), num_attributes);
+				polygon.cache = cache;
+				polygon.write_positions(&rings[i], 1);
+				polygon.fill();
+				paths[i] = polygon.get_triangulation_path();
+			}
+		});
+
+		first = last;
+	}
+
+	pool.wait();
+}
+
+GLfloat *GLBatch::get_vertices() { return vertices.data(); }
+GLuint *GLBatch::get_indices() { return indices.data(); }
+const std::vector<BatchRange> &GLBatch::get_ranges() { return ranges; }
+TriangulationPath GLBatch::get_triangulation_path(const int polygon) { return paths[polygon]; }
+int GLBatch::get_num_verts() { return vertices.size() / num_attributes; }
+int GLBatch::get_num_elements() { return indices.size(); }
+int GLBatch::get_verts_size() { return sizeof(GLfloat) * vertices.size(); }
+int GLBatch::get_indices_size() { return sizeof(GLuint) * indices.size(); }
+
+} // namespace boa
@@ -0,0 +1,51 @@
+#ifndef GL_BATCH_H
+#define GL_BATCH_H
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+#include "gl_data.h"
+#include "thread_pool.h"
+
+namespace boa {
+
+// Location of one polygon inside a GLBatch arena. Indices are relative to
+// base_vertex, ready for glDrawElementsBaseVertex.
+struct BatchRange {
+	GLint base_vertex;
+	GLuint first_index;
+	GLsizei num_elements;
+};
+
+// Triangulates many polygons at once into one contiguous vertex and index
+// arena. Offsets are laid out up front, then polygons are triangulated in
+// parallel, each writing only to its own range.
+class GLBatch {
+private:
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	std::vector<BatchRange> ranges;
+	std::vector<TriangulationPath> paths;
+
+	int num_attributes;
+
+	void gen_gl_data(const Vertices *rings, const int num_rings, ThreadPool &pool, TriangulationCache *cache);
+public:
+	GLBatch(const Vertices *rings, const int num_rings, const int stride, ThreadPool &pool, TriangulationCache *cache = nullptr);
+	GLBatch(const std::vector<Vertices> &rings, const int stride, ThreadPool &pool, TriangulationCache *cache = nullptr);
+
+	GLfloat *get_vertices();
+	GLuint *get_indices();
+	const std::vector<BatchRange> &get_ranges();
+	TriangulationPath get_triangulation_path(const int polygon);
+	int get_num_verts();
+	int get_num_elements();
+	int get_verts_size();
+	int get_indices_size();
+};
+
+} // namespace boa
+
+#endif // GL_BATCH_H
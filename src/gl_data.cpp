@@ -1,248 +1,470 @@
 #include "gl_data.h"
 
+#include "profiler.h"
+
 namespace boa {
 
-GLData::GLData(const Vertices vertices, const int stride) {
+GLData::GLData(const Vertices &vertices, const int stride, BufferAllocator *allocator, TriangulationCache *cache)
+	: GLData(&vertices, 1, stride, 0, 3, allocator, cache) {}
+
+GLData::GLData(const std::vector<Vertices> &rings, const int stride, BufferAllocator *allocator, TriangulationCache *cache)
+	: GLData(rings.data(), rings.size(), stride, 0, 3, allocator, cache) {}
+
+GLData::GLData(const Vertices *rings, const int num_rings, const int stride, const int position_offset, const int position_size,
+	BufferAllocator *allocator, TriangulationCache *cache) {
+	assert(position_size == 2 || position_size == 3);
+	assert(position_offset + position_size <= stride);
+
+	this->vertices = nullptr;
+	indices = nullptr;
+	verts_capacity = 0;
+	indices_capacity = 0;
 	num_attributes = stride;
-	gen_gl_data(vertices);
+	this->position_offset = position_offset;
+	this->position_size = position_size;
+	this->allocator = allocator;
+	this->cache = cache;
+	owns_storage = true;
+	clockwise = false;
+	gen_gl_data(rings, num_rings);
 }
 
-const int constrain(int value, const int bound) {
-	while(value >= bound) value -= bound;
-	while(value < 0) value += bound;
-
-	return value;
+GLData::GLData(GLfloat *vertices, GLuint *indices, const int num_verts, const int stride) {
+	this->vertices = vertices;
+	this->indices = indices;
+	this->num_verts = num_verts;
+	num_elements = (num_verts - 2) * 3;
+	num_attributes = stride;
+	position_offset = 0;
+	position_size = 3;
+	verts_size = sizeof(GLfloat) * num_verts * num_attributes;
+	indices_size = sizeof(GLuint) * num_elements;
+	verts_capacity = num_verts * num_attributes;
+	indices_capacity = num_elements;
+	triangulation_path = TriangulationPath::PARTITIONED; // Until fill() classifies the polygon
+	clockwise = false;
+	allocator = nullptr;
+	cache = nullptr;
+	owns_storage = false;
 }
 
-const double constrain(double value, const double bound) {
-	while(value >= bound) value -= bound;
-	while(value < 0) value += bound;
+GLData::GLData(GLData &&other) {
+	vertices = nullptr;
+	indices = nullptr;
+	owns_storage = false;
+	*this = std::move(other);
+}
 
-	return value;
+GLData &GLData::operator=(GLData &&other) {
+	if(this == &other) return *this;
+
+	release();
+	vertices = other.vertices;
+	indices = other.indices;
+	num_verts = other.num_verts;
+	num_elements = other.num_elements;
+	num_attributes = other.num_attributes;
+	position_offset = other.position_offset;
+	position_size = other.position_size;
+	verts_size = other.verts_size;
+	indices_size = other.indices_size;
+	verts_capacity = other.verts_capacity;
+	indices_capacity = other.indices_capacity;
+	triangulation_path = other.triangulation_path;
+	clockwise = other.clockwise;
+	allocator = other.allocator;
+	cache = other.cache;
+	owns_storage = other.owns_storage;
+	partition_indices = std::move(other.partition_indices);
+	partition_starts = std::move(other.partition_starts);
+	ring_starts = std::move(other.ring_starts);
+	ring_holes = std::move(other.ring_holes);
+
+	other.vertices = nullptr;
+	other.indices = nullptr;
+	other.verts_capacity = 0;
+	other.indices_capacity = 0;
+	other.num_verts = 0;
+	other.num_elements = 0;
+	other.verts_size = 0;
+	other.indices_size = 0;
+
+	return *this;
 }
 
-// Get vertices of the region defined by two sequences of points on the top and
-// bottom of a polygon.
-// NOTE: Modifies the parameters &top_start and &bottom_end (leftmost vertices) to point to
-// top_end and bottom_start (rightmost vertices), respectively.
-// Returns the indices of the subpolygon in clockwise order.
-// TODO: Redocument
-void split_polygon(const std::vector<int> &indices, const int num_verts,
-		const int top_start, const int top_end, const int bottom_start, const int bottom_end,
-		std::vector<int> &indices_1, std::vector<int> &indices_2) {
-	DEBUG("SPLITTING POLYGON: " << indices[top_start] << ", " << indices[top_end] << ", " << indices[bottom_start] << ", " << indices[bottom_end]);
+GLData::~GLData() {
+	release();
+}
 
-	for(int i = top_start; i != top_end; i = constrain(i + 1, num_verts)) {
-		indices_1.push_back(indices[i]);
-	}
-	indices_1.push_back(indices[top_end]);
+// Get storage for count elements from the allocator, or the heap if there is none
+template<typename T> T *GLData::acquire(const int count) {
+	if(allocator != nullptr) return static_cast<T*>(allocator->allocate(sizeof(T) * count));
+	return new T[count];
+}
 
-	for(int i = bottom_start; i != bottom_end; i = constrain(i + 1, num_verts)) {
-		indices_1.push_back(indices[i]);
+template<typename T> void GLData::release(T *&storage, const int count) {
+	if(storage != nullptr) {
+		if(allocator != nullptr) allocator->deallocate(storage, sizeof(T) * count);
+		else delete[] storage;
 	}
-	indices_1.push_back(indices[bottom_end]);
+	storage = nullptr;
+}
 
-	for(int i = top_end; i != bottom_start; i = constrain(i + 1, num_verts)) {
-		indices_2.push_back(indices[i]);
+void GLData::release() {
+	if(owns_storage) {
+		release(vertices, verts_capacity);
+		release(indices, indices_capacity);
 	}
-	indices_2.push_back(indices[bottom_start]);
+	verts_capacity = 0;
+	indices_capacity = 0;
+}
 
-#ifdef DEBUG_MODE
-	std::string indices_1_str = "";
-	for(int i : indices_1) indices_1_str += std::to_string(i) + " ";
-	DEBUG("\tLeft indices: " << indices_1_str);
+const int constrain(int value, const int bound) {
+	while(value >= bound) value -= bound;
+	while(value < 0) value += bound;
 
-	std::string indices_2_str = "";
-	for(int i : indices_2) indices_2_str += std::to_string(i) + " ";
-	DEBUG("\tRight indices: " << indices_2_str);
-#endif
+	return value;
 }
 
-// Divide polygon into y-monotone partitions.
-// Returns a vector of the partitions ordered from left to right.
-std::vector<std::vector<int>> GLData::partition() {
+// Sweep state shared by the edge status comparator. Edges are identified by
+// the vertex they start from, running to next[vertex]; the sentinel -1 stands
+// for the vertex currently being swept.
+struct SweepStatus {
+	const GLfloat *vertices;
+	const int *next;
+	int num_attributes;
+	int current;
+
+	const GLfloat *point(const int vertex) const { return &vertices[vertex * num_attributes]; }
+	GLfloat x(const int vertex) const { return vertices[vertex * num_attributes]; }
+	GLfloat y(const int vertex) const { return vertices[vertex * num_attributes + 1]; }
+
+	bool before(const int lhs, const int rhs) const {
+		return x(lhs) < x(rhs) || (x(lhs) == x(rhs) && y(lhs) < y(rhs));
+	}
+
+	// Endpoints of an edge from left to right
+	void endpoints(const int edge, const GLfloat *&left, const GLfloat *&right) const {
+		const int end = next[edge];
+		left = point(before(edge, end) ? edge : end);
+		right = point(before(edge, end) ? end : edge);
+	}
+};
+
+// Orders edges in the sweep status from bottom to top. Edges of a simple
+// polygon never cross, so two edges are ordered by which side of one the
+// other's endpoints lie on, and only exact orientation tests are needed.
+struct EdgeBelow {
+	const SweepStatus *status;
+
+	bool operator()(const int lhs, const int rhs) const {
+		const GLfloat *lhs_left, *lhs_right, *rhs_left, *rhs_right;
+		if(lhs < 0 || rhs < 0) {
+			// Sentinel sorts before any edge through the current vertex
+			const GLfloat *current = status->point(status->current);
+			if(lhs < 0) {
+				status->endpoints(rhs, rhs_left, rhs_right);
+				return orient2d(rhs_left, rhs_right, current) <= 0;
+			}
+			status->endpoints(lhs, lhs_left, lhs_right);
+			return orient2d(lhs_left, lhs_right, current) > 0;
+		}
+
+		status->endpoints(lhs, lhs_left, lhs_right);
+		status->endpoints(rhs, rhs_left, rhs_right);
+		double side;
+		if(rhs_left[0] > lhs_left[0] || (rhs_left[0] == lhs_left[0] && rhs_left[1] >= lhs_left[1])) {
+			side = orient2d(lhs_left, lhs_right, rhs_left);
+			if(side == 0) side = orient2d(lhs_left, lhs_right, rhs_right);
+		} else {
+			side = -orient2d(rhs_left, rhs_right, lhs_left);
+			if(side == 0) side = -orient2d(rhs_left, rhs_right, lhs_right);
+		}
+		if(side != 0) return side > 0;
+		return lhs < rhs;
+	}
+};
+
+// Divide polygon into x-monotone partitions.
+// A single left-to-right sweep adds every diagonal needed to remove split and
+// merge vertices. Holes need nothing special: walked clockwise, their leftmost
+// vertex is a split vertex and their rightmost a merge vertex, so diagonals tie
+// every hole to the boundary around it. The status of edges crossing the sweep line is kept in a
+// balanced tree whose nodes come from a pool sized to the polygon, so no
+// per-vertex allocation is made. The subpolygons cut out by the diagonals are
+// written back to back into partition_indices in clockwise order, with
+// partition k spanning [partition_starts[k], partition_starts[k + 1]).
+// Working memory is kept per thread and reused by later calls.
+void GLData::partition(std::vector<int> &partition_indices, std::vector<int> &partition_starts) {
+	PROFILE_SCOPE("GLData::partition");
 	DEBUG_TITLE("PARTITIONING " << std::to_string(num_verts) << " VERTICES");
-	struct Node {
-		int indices_index;
-		Node *prev;
-		Node *next;
-		Node *left;
-		Node *right;
-
-		Node(int indices_index, Node *prev, Node *next, Node *left, Node *right) {
-			this->indices_index = indices_index;
-			this->prev = prev;
-			this->next = next;
-			this->left = left;
-			this->right = right;
+	enum VertexType { START, END, SPLIT, MERGE, REGULAR };
+
+	// Walk outlines counterclockwise and holes clockwise regardless of input
+	// orientation, so the interior is always on the left. Vertices stay where
+	// they are and only the links to their neighbours within the ring flip.
+	// Whether a ring is a hole is only known once the sweep reaches its
+	// leftmost vertex, so its links and vertex types are set there, before
+	// any of its edges is needed. Until then next_position is -1.
+	const int num_rings = get_num_rings();
+	static thread_local std::vector<int> next_position;
+	static thread_local std::vector<int> prev_position;
+	static thread_local std::vector<signed char> turns;
+	static thread_local std::vector<char> types;
+	next_position.assign(num_verts, -1);
+	prev_position.resize(num_verts);
+	turns.resize(num_verts);
+	types.resize(num_verts);
+	if(num_rings > 1) ring_holes.assign(num_rings, false);
+	else ring_holes.clear();
+
+	SweepStatus sweep = {positions(), next_position.data(), num_attributes, 0};
+	const auto before = [&] (const int lhs, const int rhs) -> bool { return sweep.before(lhs, rhs); };
+
+	const auto start_ring = [&] (const int vertex, const bool hole) {
+		const int k = ring_starts.empty() ? 0 : std::upper_bound(ring_starts.begin(), ring_starts.end(), vertex) - ring_starts.begin() - 1;
+		const int start = ring_starts.empty() ? 0 : ring_starts[k];
+		const int end = ring_starts.empty() ? num_verts : ring_starts[k + 1];
+		const int size = end - start;
+		const GLfloat *ring_positions = &positions()[start * num_attributes];
+		if(!ring_holes.empty()) ring_holes[k] = hole;
+		DEBUG("Ring " << k << (hole ? " is a hole" : " is an outline"));
+
+		double area = 0;
+		for(int i = 0, j = size - 1; i < size; j = i++) {
+			area += (double) ring_positions[j * num_attributes] * ring_positions[i * num_attributes + 1]
+				- (double) ring_positions[i * num_attributes] * ring_positions[j * num_attributes + 1];
+		}
+		const bool reverse = hole ? area > 0 : !(area > 0);
+
+		// Turns are computed in input order, so they flip sign with the ring
+		orient2d_ring(ring_positions, num_attributes, size, &turns[start]);
+		for(int i = start; i < end; ++i) {
+			const int following = i + 1 < end ? i + 1 : start;
+			const int preceding = i > start ? i - 1 : end - 1;
+			next_position[i] = reverse ? preceding : following;
+			prev_position[i] = reverse ? following : preceding;
+		}
+		for(int i = start; i < end; ++i) {
+			const int prev = prev_position[i];
+			const int next = next_position[i];
+			const bool left_turn = reverse ? turns[i] < 0 : turns[i] > 0;
+
+			if(before(i, prev) && before(i, next))
+				types[i] = left_turn ? START : SPLIT;
+			else if(before(prev, i) && before(next, i))
+				types[i] = left_turn ? END : MERGE;
+			else
+				types[i] = REGULAR;
 		}
 	};
 
-	// Partition into monotone partitions
-	std::vector<std::vector<int>> partitions;
-
-	std::queue<std::vector<int>> subpolygons;
-	std::vector<int> all_indices(num_verts);
-	for(int i = 0; i < num_verts; ++i) all_indices[i] = i;
-	subpolygons.push(all_indices);
-
-	while(!subpolygons.empty()) {
-		// Get indices to partition
-		const std::vector<int> indices = subpolygons.front();
-		const int num_verts = indices.size();
-		subpolygons.pop();
-
-		const auto ltr_compare = [&] (int &lhs, int &rhs) -> bool { return vertices[indices[lhs] * num_attributes] > vertices[indices[rhs] * num_attributes]; }; // Multiply by num_attributes with no offset to get X coordinates
-		std::priority_queue<int, std::vector<int>, decltype(ltr_compare)> ltr_order(ltr_compare);
-
-		// Get leftmost and rightmost vertices and order vertices from left-to-right in ltr_order
-		// TODO: find left and rightmost indices by getting the top and bottom of ltr_order. Will have to change to a set to do so
-		int left_indices_index = 0;
-		int right_indices_index = 0;
-
-#ifdef DEBUG_MODE
-		std::string sub_indices_str = "";
-		for(int i = 0; i < num_verts; ++i) sub_indices_str += std::to_string(indices[i]) + " ";
-		DEBUG("SUB-INDICES: " << sub_indices_str);
-#endif
+	static thread_local std::vector<int> events;
+	events.resize(num_verts);
+	for(int i = 0; i < num_verts; ++i) events[i] = i;
+	std::sort(events.begin(), events.end(), before);
+
+	static thread_local NodePool pool(0);
+	pool.reset(num_verts);
+	using Status = std::set<int, EdgeBelow, PoolAllocator<int>>;
+	Status status(EdgeBelow{&sweep}, PoolAllocator<int>(pool));
+	static thread_local std::vector<Status::iterator> status_position;
+	status_position.assign(num_verts, status.end());
+
+	// The status only holds edges with the interior above them. Several rings
+	// also track the edges with the interior below, to tell whether a ring
+	// starts inside the polygon. An edge only ever belongs to one of the two,
+	// so they share status_position.
+	static thread_local NodePool ceiling_pool(0);
+	ceiling_pool.reset(num_rings > 1 ? num_verts : 0);
+	Status ceilings(EdgeBelow{&sweep}, PoolAllocator<int>(ceiling_pool));
+
+	static thread_local std::vector<int> helper;
+	static thread_local std::vector<std::pair<int, int>> diagonals;
+	helper.resize(num_verts);
+	diagonals.clear();
+
+	const auto insert_edge = [&] (const int edge) {
+		status_position[edge] = status.insert(edge).first;
+		helper[edge] = edge;
+	};
+	const auto erase_edge = [&] (const int edge) {
+		status.erase(status_position[edge]);
+		status_position[edge] = status.end();
+	};
+	const auto edge_below = [&] () -> int {
+		Status::iterator it = status.lower_bound(-1);
+		assert(it != status.begin()); // A simple polygon always has an edge below split, merge and upper chain vertices
+		return *(--it);
+	};
+	const auto connect_merge_helper = [&] (const int current, const int edge) {
+		if(types[helper[edge]] == MERGE) {
+			diagonals.push_back({current, helper[edge]});
+			DEBUG("\tCreated partitioning diagonal (MERGE HELPER): " << current << " | " << helper[edge]);
+		}
+	};
 
-		for(int i = 0; i < num_verts; ++i) {
-			ltr_order.push(i);
-			if(vertices[indices[i] * num_attributes] < vertices[indices[left_indices_index] * num_attributes])
-				left_indices_index = i;
-			else if(vertices[indices[i] * num_attributes] > vertices[indices[right_indices_index] * num_attributes])
-				right_indices_index = i;
+	for(const int current : events) {
+		sweep.current = current;
+		if(next_position[current] < 0) {
+			// First vertex of its ring. Rings do not cross, so it lies inside the
+			// polygon exactly when the nearest edge below has the interior above it.
+			Status::iterator floor = status.lower_bound(-1);
+			Status::iterator ceiling = ceilings.lower_bound(-1);
+			bool hole = floor != status.begin();
+			if(hole && ceiling != ceilings.begin()) hole = status.key_comp()(*std::prev(ceiling), *std::prev(floor));
+			start_ring(current, hole);
+		}
+		const int prev_edge = prev_position[current];
+		if(num_rings > 1) {
+			if(before(next_position[current], current)) ceilings.erase(status_position[current]);
+			if(before(current, prev_edge)) status_position[prev_edge] = ceilings.insert(prev_edge).first;
 		}
 
-		// Construct linked list of vertices in order of placement in the polygon, starting with the leftmost vertex
-		Node *leftmost = new Node(left_indices_index, nullptr, nullptr, nullptr, nullptr);
-		Node *rightmost = nullptr;
-		Node *current = leftmost;
-		for(int i = left_indices_index + 1; i < num_verts + left_indices_index; ++i) {
-			Node *child = new Node(i % num_verts, current, nullptr, nullptr, nullptr);
-			current->next = child;
-			current = child;
-
-			if(child->indices_index == right_indices_index)
-				rightmost = child;
+		switch(types[current]) {
+		case START:
+			insert_edge(current);
+			break;
+		case END:
+			connect_merge_helper(current, prev_edge);
+			erase_edge(prev_edge);
+			break;
+		case SPLIT: {
+			const int below = edge_below();
+			diagonals.push_back({current, helper[below]});
+			DEBUG("\tCreated partitioning diagonal (SPLIT): " << current << " | " << helper[below]);
+			helper[below] = current;
+			insert_edge(current);
+			break;
+		}
+		case MERGE: {
+			connect_merge_helper(current, prev_edge);
+			erase_edge(prev_edge);
+			const int below = edge_below();
+			connect_merge_helper(current, below);
+			helper[below] = current;
+			break;
 		}
-		current->next = leftmost;
-		leftmost->prev = current;
-
-		// Add links to left and right vertices in the linked list
-		// TODO: Try converting to std::find
-		Node *next = leftmost;
-		for(int i = 0; i < num_verts; ++i) {
-			current = next;
-			for(int j = next->indices_index; indices[j] < indices[ltr_order.top()]; ++j)
-				next = next->next;
-			for(int j = next->indices_index; indices[j] > indices[ltr_order.top()]; --j)
-				next = next->prev;
-
-			current->right = next;
-			next->left = current;
-			ltr_order.pop();
+		case REGULAR:
+			if(before(prev_edge, current)) { // Lower chain, interior lies above
+				connect_merge_helper(current, prev_edge);
+				erase_edge(prev_edge);
+				insert_edge(current);
+			} else { // Upper chain, interior lies below
+				const int below = edge_below();
+				connect_merge_helper(current, below);
+				helper[below] = current;
+			}
+			break;
 		}
+	}
 
 #ifdef DEBUG_MODE
-		Node *node = leftmost;
-		std::string ltr_str = "";
-		for(int i = 0; i < num_verts; ++i) {
-			ltr_str += std::to_string(indices[node->indices_index]) + " ";
-			node = node->right;
-		}
-		DEBUG("LEFT TO RIGHT: " << ltr_str);
+	// Every diagonal must leave both of its endpoints through the interior
+	for(const std::pair<int, int> &diagonal : diagonals) {
+		const int a = diagonal.first, b = diagonal.second;
+		assert(in_cone(sweep.point(prev_position[a]), sweep.point(a), sweep.point(next_position[a]), sweep.point(b)));
+		assert(in_cone(sweep.point(prev_position[b]), sweep.point(b), sweep.point(next_position[b]), sweep.point(a)));
+	}
 #endif
 
-		// The indices to start and end the partition. Move rightward as new partitions are created.
-		current = leftmost;
-		GLfloat current_x, current_y,
-			prev_x, prev_y,
-			next_x, next_y,
-			left_x, right_x;
-
-		bool monotone_partition = true;
-		for(int i = 0; i < num_verts; ++i) {
-			const int indices_index = current->indices_index;
-
-			// TODO: See if the check that the vertex is to the right of the leftmost index is necessary
-			current_x = vertices[indices[indices_index] * num_attributes];
-			current_y = vertices[indices[indices_index] * num_attributes + 1];
-			prev_x = vertices[indices[constrain(indices_index - 1, num_verts)] * num_attributes];
-			prev_y = vertices[indices[constrain(indices_index - 1, num_verts)] * num_attributes + 1];
-			next_x = vertices[indices[constrain(indices_index + 1, num_verts)] * num_attributes];
-			next_y = vertices[indices[constrain(indices_index + 1, num_verts)] * num_attributes + 1];
-			left_x = vertices[indices[left_indices_index] * num_attributes];
-			right_x = vertices[indices[right_indices_index] * num_attributes];
-
-			if(current_x > left_x && current_x < prev_x && current_x < next_x) {
-				const GLfloat prev_theta = std::atan2(prev_y - current_y, prev_x - current_x);
-				const GLfloat next_theta = std::atan2(next_y - current_y, next_x - current_x);
-				const GLfloat theta = std::atan2(vertices[indices[current->left->indices_index] * num_attributes + 1] - current_y, vertices[indices[current->left->indices_index] * num_attributes] - current_x);
-
-				if(prev_y > next_y ? (theta > prev_theta || theta < next_theta) : (prev_theta < theta && theta < next_theta)) {
-					// TODO: run new iterations
-					std::vector<int> indices_1;
-					std::vector<int> indices_2;
-					split_polygon(indices, num_verts, left_indices_index, std::min(indices_index, current->left->indices_index), std::max(indices_index, current->left->indices_index), constrain(left_indices_index - 1, num_verts), indices_1, indices_2);
-					subpolygons.push(indices_1);
-					subpolygons.push(indices_2);
-					DEBUG("\tCreated partitioning diagonal. (INDEX | LEFT CONNECTOR): " << indices[indices_index] << " | " << indices[current->left->indices_index]);
-					monotone_partition = false;
-					break;
-				} else {
-					DEBUG("\tFAILED DIAGONAL (INDEX | LEFT CONNECTOR): " << indices[indices_index] << " | " << indices[current->left->indices_index]);
-				}
-			} else if(current_x < right_x && current_x > prev_x && current_x > next_x) {
-				const GLfloat prev_theta = std::atan2(prev_y - current_y, prev_x - current_x);
-				const GLfloat next_theta = std::atan2(next_y - current_y, next_x - current_x);
-				const GLfloat theta = std::atan2(vertices[indices[current->right->indices_index] * num_attributes + 1] - current_y, vertices[indices[current->right->indices_index] * num_attributes] - current_x);
-
-				DEBUG("THETA (previous, current, next): " << prev_theta << ", " << theta << ", " << next_theta);
-
-				if(prev_y > next_y ? (theta > prev_theta || theta < next_theta) : (prev_theta < theta && theta < next_theta)) {
-					std::vector<int> indices_1;
-					std::vector<int> indices_2;
-					split_polygon(indices, num_verts, left_indices_index, std::min(indices_index, current->right->indices_index), std::max(indices_index, current->right->indices_index), constrain(left_indices_index - 1, num_verts), indices_1, indices_2);
-					subpolygons.push(indices_1);
-					subpolygons.push(indices_2);
-					DEBUG("\tCreated partitioning diagonal. (INDEX | RIGHT CONNECTOR): " << indices[indices_index] << " | " << indices[current->right->indices_index]);
-					monotone_partition = false;
-					break;
-				} else {
-					DEBUG("\tFAILED DIAGONAL (INDEX | RIGHT CONNECTOR): " << indices[indices_index] << " | " << indices[current->right->indices_index]);
-				}
+	partition_indices.clear();
+	partition_starts.clear();
+	partition_starts.push_back(0);
+	if(diagonals.empty() && num_rings == 1) {
+		for(int i = 0, vertex = 0; i < num_verts; ++i, vertex = prev_position[vertex]) partition_indices.push_back(vertex);
+		partition_starts.push_back(num_verts);
+		return;
+	}
+
+	// Build the outgoing half-edges of every vertex: the two polygon edges plus
+	// any diagonals, sorted counterclockwise by direction
+	const int num_diagonals = diagonals.size();
+	static thread_local std::vector<int> out_start;
+	out_start.assign(num_verts + 1, 2);
+	out_start[num_verts] = 0;
+	for(const auto &diagonal : diagonals) {
+		++out_start[diagonal.first];
+		++out_start[diagonal.second];
+	}
+	for(int i = 0, offset = 0; i <= num_verts; ++i) {
+		const int degree = out_start[i];
+		out_start[i] = offset;
+		offset += degree;
+	}
+
+	static thread_local std::vector<int> out_fill;
+	static thread_local std::vector<int> out_target;
+	out_fill.assign(out_start.begin(), out_start.end() - 1);
+	out_target.resize(2 * (num_verts + num_diagonals));
+	for(int i = 0; i < num_verts; ++i) {
+		out_target[out_fill[i]++] = next_position[i];
+		out_target[out_fill[i]++] = prev_position[i];
+	}
+	for(const auto &diagonal : diagonals) {
+		out_target[out_fill[diagonal.first]++] = diagonal.second;
+		out_target[out_fill[diagonal.second]++] = diagonal.first;
+	}
+
+	for(int i = 0; i < num_verts; ++i) {
+		const double origin_x = sweep.x(i), origin_y = sweep.y(i);
+		std::sort(out_target.begin() + out_start[i], out_target.begin() + out_start[i + 1], [&] (const int lhs, const int rhs) -> bool {
+			const double lhs_x = sweep.x(lhs) - origin_x, lhs_y = sweep.y(lhs) - origin_y;
+			const double rhs_x = sweep.x(rhs) - origin_x, rhs_y = sweep.y(rhs) - origin_y;
+			const bool lhs_lower = lhs_y < 0 || (lhs_y == 0 && lhs_x < 0);
+			const bool rhs_lower = rhs_y < 0 || (rhs_y == 0 && rhs_x < 0);
+			if(lhs_lower != rhs_lower) return rhs_lower;
+			return orient2d(sweep.point(i), sweep.point(lhs), sweep.point(rhs)) > 0;
+		});
+	}
+
+	// Trace each face by turning to the next half-edge clockwise from the
+	// reverse of the one it arrived on. Reversed polygon edges only border the
+	// outside or the inside of a hole, so they are never used to start a face.
+	static thread_local std::vector<char> used;
+	used.assign(out_target.size(), false);
+	for(int i = 0; i < num_verts; ++i) {
+		for(int e = out_start[i]; e < out_start[i + 1]; ++e) {
+			if(used[e] || out_target[e] == prev_position[i]) continue;
+
+			int from = i, half_edge = e;
+			while(!used[half_edge]) {
+				used[half_edge] = true;
+				partition_indices.push_back(from);
+
+				const int to = out_target[half_edge];
+				int twin = out_start[to];
+				while(out_target[twin] != from) ++twin;
+				half_edge = twin == out_start[to] ? out_start[to + 1] - 1 : twin - 1;
+				from = to;
 			}
 
-			if(current == rightmost)
-				break;
-			else
-				current = current->right;
+			std::reverse(partition_indices.begin() + partition_starts.back(), partition_indices.end());
+			partition_starts.push_back(partition_indices.size());
 		}
-
-		if(monotone_partition)
-			partitions.push_back(indices);
 	}
 
 #ifdef DEBUG_MODE
-	DEBUG("Created " << partitions.size() << " partitions:");
-	for(auto partition_vertices : partitions) {
+	DEBUG("Created " << partition_starts.size() - 1 << " partitions:");
+	for(int k = 0; k + 1 < (int) partition_starts.size(); ++k) {
 		std::string partition_str = "";
-		for(int i = 0; i < partition_vertices.size(); ++i) {
-			partition_str += std::to_string(partition_vertices[i]) + " ";
+		for(int i = partition_starts[k]; i < partition_starts[k + 1]; ++i) {
+			partition_str += std::to_string(partition_indices[i]) + " ";
 		}
 		DEBUG("\t" << partition_str);
 	}
 #endif
-
-	return partitions;
 }
 
-// Divide a y-monotone polygon partition into triangles.
-void GLData::triangulate(std::vector<int> partition_indices, int &start_index, int &indices_index) {
-	const int num_partition_verts = partition_indices.size();
-
+// Divide an x-monotone polygon partition into triangles.
+// The partition must be in clockwise order, so walking forward from its
+// leftmost vertex follows the upper chain. Vertices are visited from left to
+// right while a stack holds the reflex chain that has not been triangulated
+// yet. Triangles are written to indices in clockwise order.
+void GLData::triangulate(const int *partition_indices, const int num_partition_verts, int &indices_index) {
+	PROFILE_SCOPE("GLData::triangulate");
 #ifdef DEBUG_MODE
+	const int first_index = indices_index;
 	std::string vertex_string = "";
 	for(int i = 0; i < num_partition_verts; ++i) {
 		vertex_string += std::to_string(partition_indices[i]) + " ";
@@ -250,167 +472,326 @@ void GLData::triangulate(std::vector<int> partition_indices, int &start_index, i
 	DEBUG_TITLE("TRIANGULATING: " + vertex_string);
 #endif
 
+	const auto x = [&] (const int i) -> double { return positions()[partition_indices[i] * num_attributes]; };
+	const auto y = [&] (const int i) -> double { return positions()[partition_indices[i] * num_attributes + 1]; };
+	const auto before = [&] (const int lhs, const int rhs) -> bool {
+		return x(lhs) < x(rhs) || (x(lhs) == x(rhs) && y(lhs) < y(rhs));
+	};
+	const auto cross = [&] (const int origin, const int a, const int b) -> double {
+		return orient2d(&positions()[partition_indices[origin] * num_attributes], &positions()[partition_indices[a] * num_attributes],
+			&positions()[partition_indices[b] * num_attributes]);
+	};
+	const auto add_triangle = [&] (const int a, const int b, const int c) {
+		indices[indices_index++] = partition_indices[a];
+		if(cross(a, b, c) < 0) {
+			indices[indices_index++] = partition_indices[b];
+			indices[indices_index++] = partition_indices[c];
+		} else {
+			indices[indices_index++] = partition_indices[c];
+			indices[indices_index++] = partition_indices[b];
+		}
+	};
+
+	if(num_partition_verts == 3) {
+		add_triangle(0, 1, 2);
+		return;
+	}
+
 	int left_index = 0; // Index of the leftmost point (start point)
 	int right_index = 0; // Index of the rightmost point (end point)
-
-	// TODO: check if these are always the first and last vertices
 	for(int i = 1; i < num_partition_verts; ++i) {
-		// Find leftmost and rightmost vertices
-		if(vertices[partition_indices[i] * num_attributes] < vertices[partition_indices[left_index] * num_attributes])
-			left_index = i;
-		else if(vertices[partition_indices[i] * num_attributes] > vertices[partition_indices[right_index] * num_attributes])
-			right_index = i;
+		if(before(i, left_index)) left_index = i;
+		if(before(right_index, i)) right_index = i;
 	}
 
-	int top_index = left_index; // Index of top vertex
-	int bottom_index = left_index; // Index of bottom vertex
-	int current = left_index; // Vertex being analyzed
-	int last = left_index; // Last vertex to be analyzed
-
-	std::vector<int> remaining_vertices; // Vertices that have been analyzed but not triangulated. Used for creating fans.
-
-	// Sweep through vertices from left to right and triangulate each monotone polygon
-	for(int i = 0; i < num_partition_verts; ++i) {
-		// Move to next vertex to the right to analyze
-		if((vertices[partition_indices[constrain(top_index + 1, num_partition_verts)] * num_attributes] < vertices[partition_indices[constrain(bottom_index - 1, num_partition_verts)] * num_attributes] || bottom_index == right_index) && top_index != right_index) {
-			// Checks if the next top vertex is to the left of the next bottom vertex or bottom vertex is the rightmost vertex. Evaluates to false if the top vertex is the rightmost vertex.
-			// Moves the top vertex rightwards (clockwise)
-			top_index = constrain(top_index + 1, num_partition_verts);
-			last = current;
-			current = top_index;
+	// Merge the upper (clockwise) and lower (counterclockwise) chains into left-to-right order
+	static thread_local std::vector<int> order;
+	static thread_local std::vector<char> upper;
+	order.resize(num_partition_verts);
+	upper.resize(num_partition_verts);
+	int top_index = left_index;
+	int bottom_index = constrain(left_index - 1, num_partition_verts);
+	order[0] = left_index;
+	upper[0] = true;
+	for(int i = 1; i < num_partition_verts; ++i) {
+		const int next_top = constrain(top_index + 1, num_partition_verts);
+		if(top_index != right_index && (bottom_index == right_index || before(next_top, bottom_index))) {
+			top_index = next_top;
+			order[i] = top_index;
+			upper[i] = true;
 		} else {
-			// Moves the bottom vertex rightwards (counterclockwise)
+			order[i] = bottom_index;
+			upper[i] = bottom_index == right_index; // The rightmost vertex ends both chains
 			bottom_index = constrain(bottom_index - 1, num_partition_verts);
-			last = current;
-			current = bottom_index;
 		}
+	}
 
-		remaining_vertices.push_back(last);
-
-		/* If the next vertex is on the bottom half of the polygon and the previous
-		 * vertices that don't form triangles are on the top half (or vice-versa),
-		 * then the current point and all of the previous points will form a series
-		 * of triangles shaped similarly to a chinese fan. If a fan of triangles is
-		 * formed, add each of the triangles in the fan.
-		 */
-		DEBUG("Top index, bottom index: " << partition_indices[top_index] << ", " << partition_indices[bottom_index] << " | index " << indices_index << " of " << ((num_verts - 2) * 3));
-		if(remaining_vertices.size() > 1 && indices_index < (num_verts - 2) * 3 /*&& (top_index != left_index && bottom_index != left_index)*/) { // On top half and neither top or bottom vertices are the leftmost vertex
-			if((current == top_index && current - 1 != last) || (current == bottom_index && current + 1 != last)) { // Last vertex was not on same top/bottom half of the partition as the current vertex
-#ifdef DEBUG_MODE
-				DEBUG("FAN");
-				std::string str = "";
-				for(auto i : remaining_vertices) str += std::to_string(partition_indices[i]) + " ";
-				DEBUG("\tRemaining vertices: " << str);
-#endif
+	static thread_local std::vector<int> stack;
+	stack.clear();
+	stack.push_back(0);
+	stack.push_back(1);
 
-				const int num_vertices_to_add = remaining_vertices.size() - 1;
-				for(int j = 0; j < num_vertices_to_add; ++j) {
-					// Add vertices in clockwise order
-					const int vert_a = remaining_vertices.front();
-					remaining_vertices.erase(remaining_vertices.begin());
-					const int vert_b = remaining_vertices.front();
-					if(current == vert_a || current == vert_b) {
-						// TODO: Figure out why this is needed. Shouldn't the current vertex not be in the remaining vertices?
-						DEBUG("\tABORTING FAN: " << partition_indices[current] << ", " << partition_indices[vert_a] << ", " << partition_indices[vert_b]);
-						break;
-					}
-
-					// Add triangle of fan to partition_indices
-					indices[indices_index++] = partition_indices[current];
-					if(vertices[partition_indices[vert_a] * num_attributes + 1] < vertices[partition_indices[vert_b] * num_attributes + 1]) { // If first vertex is to the left of the second
-						indices[indices_index++] = partition_indices[vert_a];
-						indices[indices_index++] = partition_indices[vert_b];
-					} else {
-						indices[indices_index++] = partition_indices[vert_b];
-						indices[indices_index++] = partition_indices[vert_a];
-					}
-
-					DEBUG("\tResultant indices: " << indices[indices_index - num_attributes] << ", " << indices[indices_index - 2] << ", " << indices[indices_index - 1]);
-				}
-#ifdef DEBUG_MODE
-				str = "";
-				for(auto i : remaining_vertices) str += std::to_string(partition_indices[i]) + " ";
-				DEBUG("\tRemaining vertices: " << str);
-#endif
-			} else {
-			// If the last vertex was on the same half as the current one and a fan is not formed, check if a triangular ear is formed
-				DEBUG("Checking for ear");
-				const int prev_prev_index = partition_indices[constrain(remaining_vertices[remaining_vertices.size() - 2], num_partition_verts)];
-				const int prev_index = partition_indices[constrain(remaining_vertices.back(), num_partition_verts)];
-				const int current_index = partition_indices[constrain(current, num_partition_verts)];
-				DEBUG("\tAngle segment: (" << prev_prev_index << ", " << prev_index << ", " << current_index << ")");
-
-				const GLfloat prev_theta = std::atan2(vertices[prev_prev_index * num_attributes + 1] - vertices[prev_index * num_attributes + 1], vertices[prev_prev_index * num_attributes] - vertices[prev_index * num_attributes]);
-				const GLfloat current_theta = std::atan2(vertices[current_index * num_attributes + 1] - vertices[prev_index * num_attributes + 1], vertices[current_index * num_attributes] - vertices[prev_index * num_attributes]);
-
-				if(current == top_index) { // Ear on top
-					const GLfloat net_theta = constrain(current_theta - prev_theta, 2 * boa::PI);
-					DEBUG("\tPrevious theta, current theta, net theta: " << prev_theta << ", " << current_theta << ", " << net_theta);
-					if (net_theta < boa::PI) {
-						DEBUG("\tUPPER EAR around " << partition_indices[current]);
-						indices[indices_index++] = partition_indices[current];
-						indices[indices_index + 1] = partition_indices[remaining_vertices.back()];
-						remaining_vertices.pop_back();
-						indices[indices_index] = partition_indices[remaining_vertices.back()];
-						indices_index += 2;
-						DEBUG("\tResultant indices: " << indices[indices_index - num_attributes] << ", " << indices[indices_index - 2] << ", " << indices[indices_index - 1]);
-					}
-				} else if(current == bottom_index) { // Ear on bottom
-					const GLfloat net_theta = constrain(prev_theta - current_theta, 2 * boa::PI);
-					DEBUG("\tPrevious theta, current theta, net theta: " << prev_theta << ", " << current_theta << ", " << net_theta);
-					if (net_theta < boa::PI) {
-						DEBUG("\tLOWER EAR around " << partition_indices[current]);
-						indices[indices_index++] = partition_indices[current];
-						indices[indices_index++] = partition_indices[remaining_vertices.back()];
-						remaining_vertices.pop_back();
-						indices[indices_index++] = partition_indices[remaining_vertices.back()];
-						DEBUG("\tResultant indices: " << indices[indices_index - num_attributes] << ", " << indices[indices_index - 2] << ", " << indices[indices_index - 1]);
-					}
-				}
+	for(int i = 2; i < num_partition_verts - 1; ++i) {
+		if(upper[i] != upper[stack.back()]) {
+			// Opposite chain: the current vertex sees every vertex on the stack, forming a fan
+			for(std::size_t j = stack.size() - 1; j > 0; --j) {
+				add_triangle(order[i], order[stack[j]], order[stack[j - 1]]);
 			}
+			const int last = stack.back();
+			stack.clear();
+			stack.push_back(last);
+			stack.push_back(i);
+		} else {
+			// Same chain: cut off ears while the diagonal to the stack stays inside the partition
+			int last = stack.back();
+			stack.pop_back();
+			while(!stack.empty()) {
+				const double turn = cross(order[stack.back()], order[i], order[last]);
+				if(upper[i] ? turn <= 0 : turn >= 0) break;
+
+				add_triangle(order[i], order[last], order[stack.back()]);
+				last = stack.back();
+				stack.pop_back();
+			}
+			stack.push_back(last);
+			stack.push_back(i);
 		}
 	}
 
+	// The rightmost vertex closes every remaining triangle
+	const int last = num_partition_verts - 1;
+	for(std::size_t j = stack.size() - 1; j > 0; --j) {
+		add_triangle(order[last], order[stack[j]], order[stack[j - 1]]);
+	}
+
 #ifdef DEBUG_MODE
 	std::string indices_str = "";
-	for(int i = 0; i < (num_partition_verts - 2) * 3; ++i) {
+	for(int i = first_index; i < indices_index; i += 3) {
 		indices_str += "(";
-		indices_str += std::to_string(indices[start_index + i]) + ", ";
-		indices_str += std::to_string(indices[start_index + (++i)]) + ", ";
-		indices_str += std::to_string(indices[start_index + (++i)]);
+		indices_str += std::to_string(indices[i]) + ", ";
+		indices_str += std::to_string(indices[i + 1]) + ", ";
+		indices_str += std::to_string(indices[i + 2]);
 		indices_str += ") ";
 	}
 	DEBUG("Partition indices: " << indices_str << std::endl);
 #endif
+}
+
+// Classify the polygon in one pass to pick the cheapest triangulation.
+// A polygon is x-monotone if its boundary changes horizontal direction only at
+// the leftmost and rightmost vertices, and convex if it is also monotone and
+// never turns against its orientation. Sets clockwise to the orientation.
+TriangulationPath GLData::classify(bool &clockwise) const {
+	const auto x = [&] (const int i) -> double { return positions()[i * num_attributes]; };
+	const auto y = [&] (const int i) -> double { return positions()[i * num_attributes + 1]; };
+	const auto before = [&] (const int lhs, const int rhs) -> bool {
+		return x(lhs) < x(rhs) || (x(lhs) == x(rhs) && y(lhs) < y(rhs));
+	};
+
+	static thread_local std::vector<signed char> turns;
+	turns.resize(num_verts);
+	orient2d_ring(positions(), num_attributes, num_verts, turns.data());
+
+	double area = 0;
+	bool left_turn = false;
+	bool right_turn = false;
+	int direction_changes = 0;
+	for(int i = 0; i < num_verts; ++i) {
+		const int prev = constrain(i - 1, num_verts);
+		const int next = constrain(i + 1, num_verts);
+
+		area += x(prev) * y(i) - x(i) * y(prev);
+
+		if(turns[i] > 0) left_turn = true;
+		else if(turns[i] < 0) right_turn = true;
 
-	start_index += num_partition_verts;
+		if(before(prev, i) != before(i, next)) ++direction_changes;
+	}
+
+	clockwise = area < 0;
+	if(direction_changes > 2) return TriangulationPath::PARTITIONED;
+	if(left_turn && right_turn) return TriangulationPath::MONOTONE;
+	return TriangulationPath::CONVEX_FAN;
 }
 
 void GLData::gen_gl_data(const Vertices &raw_vertices) {
-	num_verts = raw_vertices.size();
-	num_elements = (raw_vertices.size() - 2) * 3;
+	gen_gl_data(&raw_vertices, 1);
+}
 
-	vertices = new GLfloat[num_verts * num_attributes];
+void GLData::gen_gl_data(const std::vector<Vertices> &rings) {
+	gen_gl_data(rings.data(), rings.size());
+}
 
-	for(int i = 0; i < num_verts; ++i) {
-		// Format vertices for OpenGL
-		vertices[i * num_attributes] = raw_vertices[i][0];
-		vertices[i * num_attributes + 1] = raw_vertices[i][1];
-		vertices[i * num_attributes + 2] = 0.0f;
+void GLData::gen_gl_data(const Vertices *rings, const int num_rings) {
+	PROFILE_SCOPE("GLData::gen_gl_data");
+
+	// Keep the existing storage when it is large enough
+	if(!owns_storage) {
+		ERROR("Cannot regenerate GLData that views external storage");
+		return;
 	}
 
-	indices = new GLuint[num_elements];
-	int indices_index = 0; // Index of gl_indices to add to
-	int index = 0;
+	// Leave nothing to draw rather than triangulate a degenerate ring
+	bool valid = num_rings > 0;
+	if(!valid) ERROR("Polygon has no rings");
+	num_verts = 0;
+	for(int k = 0; k < num_rings; ++k) {
+		if(rings[k].size() < 3) {
+			ERROR("Ring " << k << " has fewer than 3 vertices");
+			valid = false;
+		}
+		num_verts += rings[k].size();
+	}
+	if(!valid) {
+		num_verts = 0;
+		num_elements = 0;
+		verts_size = 0;
+		indices_size = 0;
+		triangulation_path = TriangulationPath::CONVEX_FAN;
+		ring_starts.clear();
+		ring_holes.clear();
+		partition_indices.clear();
+		partition_starts.clear();
+		return;
+	}
 
-	// Divide polygon into y-monotone partitions and triangulate each partition
-	const std::vector<std::vector<int>> partitions = partition();
-	for(const std::vector<int> indices : partitions) {
-		triangulate(indices, index, indices_index);
+	if(num_verts * num_attributes > verts_capacity) {
+		release(vertices, verts_capacity);
+		verts_capacity = num_verts * num_attributes;
+		vertices = acquire<GLfloat>(verts_capacity);
 	}
+	write_positions(rings, num_rings);
+
+	// Several rings are counted once partitioned, as holes add triangles
+	num_elements = ring_starts.empty() ? (num_verts - 2) * 3 : 0;
+	reserve_indices();
+
+	fill();
 
 	verts_size = sizeof(GLfloat) * num_verts * num_attributes;
-	indices_size = sizeof(GLint) * num_elements;
+	indices_size = sizeof(GLuint) * num_elements;
+}
+
+// Format the rings' vertices for OpenGL, back to back, remembering where each
+// ring starts when there is more than one
+void GLData::write_positions(const Vertices *rings, const int num_rings) {
+	ring_starts.clear();
+	int i = 0;
+	for(int k = 0; k < num_rings; ++k) {
+		if(num_rings > 1) ring_starts.push_back(i);
+		for(const glm::vec4 &raw_vertex : rings[k]) {
+			GLfloat *position = &positions()[i++ * num_attributes];
+			position[0] = raw_vertex[0];
+			position[1] = raw_vertex[1];
+			if(position_size == 3) position[2] = 0.0f;
+		}
+	}
+	if(num_rings > 1) ring_starts.push_back(i);
+}
+
+void GLData::reserve_indices() {
+	if(num_elements <= indices_capacity) return;
+
+	release(indices, indices_capacity);
+	indices_capacity = num_elements;
+	indices = acquire<GLuint>(indices_capacity);
+}
+
+// Write triangle indices for the current positions into the current storage,
+// which must already hold num_verts vertices and, for a single ring,
+// num_elements indices. Several rings size the indices themselves.
+// Owning GLData keeps its partitions for update_vertices, views only need them briefly
+std::vector<int> &GLData::piece_indices() {
+	static thread_local std::vector<int> scratch_indices;
+	return owns_storage ? partition_indices : scratch_indices;
+}
+
+std::vector<int> &GLData::piece_starts() {
+	static thread_local std::vector<int> scratch_starts;
+	return owns_storage ? partition_starts : scratch_starts;
+}
+
+void GLData::split() {
+	// Several rings always need the sweep to tie holes and outlines together
+	clockwise = false;
+	triangulation_path = ring_starts.empty() ? classify(clockwise) : TriangulationPath::PARTITIONED;
+	DEBUG("Triangulation path: " << (int) triangulation_path);
+
+	std::vector<int> &piece_indices = this->piece_indices();
+	std::vector<int> &piece_starts = this->piece_starts();
+	if(triangulation_path == TriangulationPath::PARTITIONED) {
+		// Divide polygon into x-monotone partitions
+		partition(piece_indices, piece_starts);
+
+		// Each partition of n vertices makes n - 2 triangles, so a polygon of n
+		// vertices with h holes and c outlines makes n + 2h - 2c in all
+		if(!ring_starts.empty()) {
+			num_elements = (piece_indices.size() - 2 * (piece_starts.size() - 1)) * 3;
+			reserve_indices();
+		}
+	} else {
+		// Convex or already x-monotone, so the whole polygon is a single partition
+		piece_indices.resize(num_verts);
+		for(int i = 0; i < num_verts; ++i) piece_indices[i] = clockwise ? i : num_verts - 1 - i;
+		piece_starts.assign({0, num_verts});
+	}
+}
+
+int GLData::triangulate_partitions() {
+	int indices_index = 0; // Index of gl_indices to add to
+	if(triangulation_path == TriangulationPath::CONVEX_FAN) {
+		// Fan out from the first vertex, keeping triangles clockwise
+		for(int i = 1; i < num_verts - 1; ++i) {
+			indices[indices_index++] = 0;
+			indices[indices_index++] = clockwise ? i : i + 1;
+			indices[indices_index++] = clockwise ? i + 1 : i;
+		}
+		return indices_index;
+	}
+
+	const std::vector<int> &piece_indices = this->piece_indices();
+	const std::vector<int> &piece_starts = this->piece_starts();
+	for(int k = 0; k + 1 < (int) piece_starts.size(); ++k) {
+		const int num_partition_verts = piece_starts[k + 1] - piece_starts[k];
+		if(indices_index + (num_partition_verts - 2) * 3 > num_elements) {
+			ERROR("Partitions exceed " << num_elements / 3 << " triangles; polygon is not simple");
+			break;
+		}
+		triangulate(&piece_indices[piece_starts[k]], num_partition_verts, indices_index);
+	}
+	return indices_index;
+}
+
+void GLData::fill() {
+	// Reuse the triangulation of an identical shape if one is cached. Cache
+	// keys describe a single ring, so shapes with several are always triangulated.
+	static thread_local std::vector<GLfloat> shape;
+	std::uint64_t shape_hash = 0;
+	const bool cached = cache != nullptr && ring_starts.empty();
+	if(cached) {
+		shape_hash = TriangulationCache::make_key(positions(), num_verts, num_attributes, shape);
+		if(cache->find(shape_hash, shape, positions(), num_attributes, indices, num_elements, triangulation_path)) {
+			DEBUG("Triangulation cache hit: " << shape_hash);
+			partition_indices.clear();
+			partition_starts.clear();
+			return;
+		}
+	}
+
+	split();
+	const int indices_index = triangulate_partitions();
+
+	if(indices_index < num_elements) {
+		// Only the triangles written so far are valid. A view's range is fixed
+		// by its batch, so pad it with degenerate triangles instead.
+		if(owns_storage) num_elements = indices_index;
+		else std::fill(indices + indices_index, indices + num_elements, 0);
+		piece_indices().clear(); // Never reused by update_vertices
+		piece_starts().clear();
+		return;
+	}
+
+	if(cached) cache->insert(shape_hash, shape, positions(), num_attributes, indices, num_elements, triangulation_path);
 
 #ifdef DEBUG_MODE
 	std::string indices_str = "";
@@ -425,11 +806,140 @@ void GLData::gen_gl_data(const Vertices &raw_vertices) {
 #endif
 }
 
+// Check that a partition is still a simple clockwise x-monotone polygon: its
+// boundary only changes horizontal direction at the ends, and walking both
+// chains from left to right the upper chain stays above the lower one.
+bool GLData::valid_partition(const int *partition_indices, const int num_partition_verts) const {
+	const auto x = [&] (const int i) -> double { return positions()[partition_indices[i] * num_attributes]; };
+	const auto y = [&] (const int i) -> double { return positions()[partition_indices[i] * num_attributes + 1]; };
+	const auto before = [&] (const int lhs, const int rhs) -> bool {
+		return x(lhs) < x(rhs) || (x(lhs) == x(rhs) && y(lhs) < y(rhs));
+	};
+	const auto cross = [&] (const int origin, const int a, const int b) -> double {
+		return orient2d(&positions()[partition_indices[origin] * num_attributes], &positions()[partition_indices[a] * num_attributes],
+			&positions()[partition_indices[b] * num_attributes]);
+	};
+
+	int left_index = 0;
+	int right_index = 0;
+	int direction_changes = 0;
+	for(int i = 0; i < num_partition_verts; ++i) {
+		const int prev = constrain(i - 1, num_partition_verts);
+		const int next = constrain(i + 1, num_partition_verts);
+		if(before(prev, i) != before(i, next)) ++direction_changes;
+		if(before(i, left_index)) left_index = i;
+		if(before(right_index, i)) right_index = i;
+	}
+	if(direction_changes > 2) return false;
+
+	int top_index = left_index;
+	int bottom_index = left_index;
+	for(int i = 1; i < num_partition_verts; ++i) {
+		const int next_top = constrain(top_index + 1, num_partition_verts);
+		const int next_bottom = constrain(bottom_index - 1, num_partition_verts);
+		if(top_index != right_index && (bottom_index == right_index || before(next_top, next_bottom))) {
+			top_index = next_top;
+			if(top_index != right_index && bottom_index != right_index && cross(bottom_index, next_bottom, top_index) <= 0) return false;
+		} else {
+			bottom_index = next_bottom;
+			if(bottom_index != right_index && top_index != right_index && cross(top_index, next_top, bottom_index) >= 0) return false;
+		}
+	}
+
+	return true;
+}
+
+UpdateResult GLData::update_vertices(const Vertices &raw_vertices) {
+	return update_vertices(&raw_vertices, 1);
+}
+
+UpdateResult GLData::update_vertices(const std::vector<Vertices> &rings) {
+	return update_vertices(rings.data(), rings.size());
+}
+
+// Move the polygon's vertices without changing how many there are in each
+// ring. Only the vertex array is rewritten while every triangle keeps its
+// clockwise winding. Partitions containing a flipped triangle are
+// retriangulated in place if they are still valid x-monotone polygons;
+// otherwise the whole polygon is triangulated again. Returns which of these
+// was needed.
+UpdateResult GLData::update_vertices(const Vertices *rings, const int num_rings) {
+	PROFILE_SCOPE("GLData::update_vertices");
+	int num_raw_verts = 0;
+	for(int k = 0; k < num_rings; ++k) num_raw_verts += rings[k].size();
+
+	bool same_layout = owns_storage && num_raw_verts == num_verts && num_rings == get_num_rings();
+	for(int k = 0; same_layout && num_rings > 1 && k < num_rings; ++k) {
+		same_layout = (int) rings[k].size() == ring_starts[k + 1] - ring_starts[k];
+	}
+	if(!same_layout) {
+		gen_gl_data(rings, num_rings);
+		return UpdateResult::FULL_RETRIANGULATION;
+	}
+
+	write_positions(rings, num_rings);
+
+	// Clockwise triangles turn right, so a left turn means the triangle flipped
+	static thread_local std::vector<signed char> turns;
+	turns.resize(num_elements / 3);
+	orient2d_triangles(positions(), num_attributes, indices, num_elements / 3, turns.data());
+	const auto flipped = [&] (const int first_index, const int last_index) -> bool {
+		for(int t = first_index / 3; t < last_index / 3; ++t) {
+			if(turns[t] > 0) return true;
+		}
+		return false;
+	};
+
+	// Partitions are unknown after a cache hit or a failed triangulation
+	if(partition_starts.empty()) {
+		if(!flipped(0, num_elements)) return UpdateResult::VERTICES_ONLY;
+
+		gen_gl_data(rings, num_rings);
+		return UpdateResult::FULL_RETRIANGULATION;
+	}
+
+	// The partitions must account for exactly the current triangles
+	const int num_partitions = partition_starts.size() - 1;
+	if((partition_starts.back() - 2 * num_partitions) * 3 != num_elements) {
+		gen_gl_data(rings, num_rings);
+		return UpdateResult::FULL_RETRIANGULATION;
+	}
+
+	UpdateResult result = UpdateResult::VERTICES_ONLY;
+	for(int k = 0, first_index = 0; k < num_partitions; ++k) {
+		const int *piece = &partition_indices[partition_starts[k]];
+		const int num_piece_verts = partition_starts[k + 1] - partition_starts[k];
+		const int last_index = std::min(first_index + (num_piece_verts - 2) * 3, num_elements);
+
+		if(flipped(first_index, last_index)) {
+			if(!valid_partition(piece, num_piece_verts)) {
+				DEBUG("Partition " << k << " is no longer monotone, retriangulating polygon");
+				gen_gl_data(rings, num_rings); // Holes may have moved in or out of other rings
+				return UpdateResult::FULL_RETRIANGULATION;
+			}
+
+			DEBUG("Retriangulating partition " << k);
+			int indices_index = first_index;
+			triangulate(piece, num_piece_verts, indices_index);
+			result = UpdateResult::PARTITIONS_RETRIANGULATED;
+		}
+
+		first_index = last_index;
+	}
+
+	return result;
+}
+
 GLfloat *GLData::get_vertices() { return vertices; }
 GLuint *GLData::get_indices() { return indices; }
 int GLData::get_num_verts() { return num_verts; }
 int GLData::get_num_elements() { return num_elements; }
+int GLData::get_stride() { return num_attributes; }
 int GLData::get_verts_size() { return verts_size; }
 int GLData::get_indices_size() { return indices_size; }
+int GLData::get_num_rings() { return ring_starts.empty() ? 1 : ring_starts.size() - 1; }
+int GLData::get_ring_start(const int ring) { return ring_starts.empty() ? (ring == 0 ? 0 : num_verts) : ring_starts[ring]; }
+bool GLData::is_hole(const int ring) { return !ring_holes.empty() && ring_holes[ring]; }
+TriangulationPath GLData::get_triangulation_path() { return triangulation_path; }
 
 } // namespace boa
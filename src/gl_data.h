@@ -3,9 +3,10 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
 #include <cmath>
 #include <iostream>
-#include <queue>
+#include <set>
 #include <vector>
 
 #include <GL/glew.h>
@@ -14,11 +15,28 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "boa_global.h"
+#include "pool_allocator.h"
+#include "predicates.h"
+#include "triangulation_cache.h"
 
 namespace boa {
 
 using Vertices = std::vector<glm::vec4>;
 
+// How gen_gl_data triangulated its polygon
+enum class TriangulationPath {
+	CONVEX_FAN, // Convex polygon, fanned from its first vertex
+	MONOTONE, // Already x-monotone, triangulated without partitioning
+	PARTITIONED // Split into x-monotone partitions first
+};
+
+// What GLData::update_vertices had to redo
+enum class UpdateResult {
+	VERTICES_ONLY, // Every triangle stayed valid
+	PARTITIONS_RETRIANGULATED, // Some partitions were triangulated again
+	FULL_RETRIANGULATION // The whole polygon was triangulated again
+};
+
 template<typename T> concept bool AttributeContainer() {
 	return requires(T t, int i) { {t[i]}; } &&
 		(requires(T t) { {t.length()} -> std::size_t; } ||
@@ -27,14 +45,35 @@ template<typename T> concept bool AttributeContainer() {
 
 class GLData {
 private:
+	friend class GLBatch;
+
 	GLfloat *vertices;
 	GLuint *indices;
 
 	int num_verts;
 	int num_elements;
 	int num_attributes;
+	int position_offset; // GLfloats before the position in each vertex
+	int position_size; // 2, or 3 to also write a zero z
 	int verts_size;
 	int indices_size;
+	int verts_capacity; // Allocated GLfloats, may exceed the current vertex count
+	int indices_capacity; // Allocated GLuints, may exceed num_elements
+	TriangulationPath triangulation_path;
+	bool clockwise; // Winding of a single ring, from classify()
+
+	BufferAllocator *allocator; // nullptr uses new[] and delete[]
+	TriangulationCache *cache; // nullptr always triangulates
+	bool owns_storage;
+
+	// Partitions behind the current indices, laid out as by partition()
+	std::vector<int> partition_indices;
+	std::vector<int> partition_starts;
+
+	// Ring k spans vertices [ring_starts[k], ring_starts[k + 1]), and is a hole
+	// if ring_holes[k] is set by partition(). Both are empty for a single ring.
+	std::vector<int> ring_starts;
+	std::vector<char> ring_holes;
 
 	template<typename T> requires requires (T t) {
 		{t.length()} -> std::size_t;
@@ -48,19 +87,67 @@ private:
 		return t.size();
 	}
 
-	std::vector<std::vector<int>> partition();
-	void triangulate(std::vector<int> indices, int &start_index, int &indices_index);
+	GLfloat *positions() const { return vertices + position_offset; }
+
+	// Views storage owned by someone else, such as a GLBatch arena
+	GLData(GLfloat *vertices, GLuint *indices, const int num_verts, const int stride);
+
+	template<typename T> T *acquire(const int count);
+	template<typename T> void release(T *&storage, const int count);
+	void release();
+
+	void gen_gl_data(const Vertices *rings, const int num_rings);
+	UpdateResult update_vertices(const Vertices *rings, const int num_rings);
+	void write_positions(const Vertices *rings, const int num_rings);
+	void reserve_indices(); // Grow indices to hold num_elements
+	void fill();
+	std::vector<int> &piece_indices(); // partition_indices, or per-thread scratch for views
+	std::vector<int> &piece_starts();
+	TriangulationPath classify(bool &clockwise) const;
+	void partition(std::vector<int> &partition_indices, std::vector<int> &partition_starts);
+	void triangulate(const int *partition_indices, const int num_partition_verts, int &indices_index);
+	bool valid_partition(const int *partition_indices, const int num_partition_verts) const;
+protected:
+	// Places positions anywhere in the vertex, as laid out by a VertexFormat
+	GLData(const Vertices *rings, const int num_rings, const int stride, const int position_offset, const int position_size,
+		BufferAllocator *allocator, TriangulationCache *cache);
 public:
-	GLData(const Vertices vertices, const int stride);
+	GLData(const Vertices &vertices, const int stride, BufferAllocator *allocator = nullptr, TriangulationCache *cache = nullptr);
+	// Several rings triangulated together into one vertex and index array.
+	// Rings may be given in any order and orientation, but must not touch or
+	// cross. A ring inside an odd number of others is a hole, so outlines,
+	// their holes and islands within the holes can all be mixed.
+	GLData(const std::vector<Vertices> &rings, const int stride, BufferAllocator *allocator = nullptr, TriangulationCache *cache = nullptr);
+	GLData(const GLData&) = delete;
+	GLData(GLData &&other);
+	~GLData();
+
+	GLData &operator=(const GLData&) = delete;
+	GLData &operator=(GLData &&other);
 
 	GLfloat *get_vertices();
 	GLuint *get_indices();
 	int get_num_verts();
 	int get_num_elements();
+	int get_stride(); // GLfloats per vertex
 	int get_verts_size();
 	int get_indices_size();
+	int get_num_rings();
+	int get_ring_start(const int ring); // Ring k spans [get_ring_start(k), get_ring_start(k + 1))
+	bool is_hole(const int ring);
+	TriangulationPath get_triangulation_path();
+
+	// The stages of gen_gl_data's triangulation, exposed so they can be timed
+	// apart. split() classifies the current vertices and divides them into
+	// x-monotone partitions; triangulate_partitions() then writes the
+	// partitions' triangles and returns the number of indices written.
+	void split();
+	int triangulate_partitions();
 
 	void gen_gl_data(const Vertices &vertices);
+	void gen_gl_data(const std::vector<Vertices> &rings);
+	UpdateResult update_vertices(const Vertices &vertices);
+	UpdateResult update_vertices(const std::vector<Vertices> &rings);
 
 	GLData &set_attribute(const int offset, const AttributeContainer attribute) {
 		int num_attr_elements = get_num_elements(attribute[0]);
@@ -0,0 +1,171 @@
+#include "gl_state.h"
+
+namespace boa {
+
+GLState::GLState() {
+	num_issued = 0;
+	num_elided = 0;
+	enabled = true;
+	invalidate();
+}
+
+int GLState::buffer_index(const GLenum target) {
+	switch(target) {
+	case GL_ARRAY_BUFFER: return 0;
+	case GL_ELEMENT_ARRAY_BUFFER: return 1;
+	case GL_COPY_READ_BUFFER: return 2;
+	case GL_COPY_WRITE_BUFFER: return 3;
+	case GL_PIXEL_PACK_BUFFER: return 4;
+	case GL_PIXEL_UNPACK_BUFFER: return 5;
+	case GL_UNIFORM_BUFFER: return 6;
+	case GL_DRAW_INDIRECT_BUFFER: return 7;
+	default: return -1;
+	}
+}
+
+int GLState::texture_index(const GLenum target) {
+	switch(target) {
+	case GL_TEXTURE_2D: return 0;
+	case GL_TEXTURE_2D_ARRAY: return 1;
+	case GL_TEXTURE_CUBE_MAP: return 2;
+	case GL_TEXTURE_3D: return 3;
+	default: return -1;
+	}
+}
+
+// Update a shadow value, returning whether the GL call is needed
+bool GLState::change(GLuint &shadow, const GLuint value) {
+	if(enabled && shadow == value) {
+		++num_elided;
+		return false;
+	}
+
+	shadow = value;
+	++num_issued;
+	return true;
+}
+
+void GLState::use_program(const GLuint program) {
+	if(change(this->program, program)) glUseProgram(program);
+}
+
+void GLState::bind_vertex_array(const GLuint vertex_array) {
+	if(change(this->vertex_array, vertex_array)) {
+		glBindVertexArray(vertex_array);
+		buffers[buffer_index(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+	}
+}
+
+void GLState::bind_buffer(const GLenum target, const GLuint buffer) {
+	const int index = buffer_index(target);
+	if(index < 0) {
+		++num_issued;
+		glBindBuffer(target, buffer);
+	} else if(change(buffers[index], buffer)) {
+		glBindBuffer(target, buffer);
+	}
+}
+
+void GLState::bind_buffer_base(const GLenum target, const GLuint index, const GLuint buffer) {
+	++num_issued;
+	glBindBufferBase(target, index, buffer);
+
+	const int target_index = buffer_index(target);
+	if(target_index >= 0) buffers[target_index] = buffer;
+}
+
+void GLState::active_texture(const GLuint unit) {
+	if(change(active_unit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GLState::bind_texture(const GLenum target, const GLuint texture) {
+	const int index = texture_index(target);
+	if(index >= 0 && active_unit < MAX_TEXTURE_UNITS) {
+		if(change(textures[active_unit][index], texture)) glBindTexture(target, texture);
+		return;
+	}
+
+	++num_issued;
+	glBindTexture(target, texture);
+
+	// Without knowing the active unit, any unit's binding may have changed
+	if(index >= 0 && active_unit == UNKNOWN) {
+		for(GLuint (&unit)[NUM_TEXTURE_TARGETS] : textures) unit[index] = UNKNOWN;
+	}
+}
+
+void GLState::bind_texture(const GLenum target, const GLuint unit, const GLuint texture) {
+	active_texture(unit);
+	bind_texture(target, texture);
+}
+
+void GLState::delete_program(const GLuint program) {
+	if(program == 0) return;
+
+	// A current program is only deleted once it stops being current, so the
+	// binding is still real; forget it anyway in case the name is reused
+	if(this->program == program) this->program = UNKNOWN;
+	glDeleteProgram(program);
+}
+
+void GLState::delete_vertex_arrays(const GLsizei count, const GLuint *vertex_arrays) {
+	for(GLsizei i = 0; i < count; ++i) {
+		if(vertex_arrays[i] != 0 && vertex_array == vertex_arrays[i]) {
+			vertex_array = 0;
+			buffers[buffer_index(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+		}
+	}
+	glDeleteVertexArrays(count, vertex_arrays);
+}
+
+void GLState::delete_buffers(const GLsizei count, const GLuint *buffers) {
+	for(GLsizei i = 0; i < count; ++i) {
+		if(buffers[i] == 0) continue;
+		for(GLuint &buffer : this->buffers) {
+			if(buffer == buffers[i]) buffer = 0;
+		}
+	}
+	glDeleteBuffers(count, buffers);
+}
+
+void GLState::delete_textures(const GLsizei count, const GLuint *textures) {
+	for(GLsizei i = 0; i < count; ++i) {
+		if(textures[i] == 0) continue;
+		for(GLuint (&unit)[NUM_TEXTURE_TARGETS] : this->textures) {
+			for(GLuint &texture : unit) {
+				if(texture == textures[i]) texture = 0;
+			}
+		}
+	}
+	glDeleteTextures(count, textures);
+}
+
+void GLState::invalidate() {
+	program = UNKNOWN;
+	vertex_array = UNKNOWN;
+	active_unit = UNKNOWN;
+	for(GLuint &buffer : buffers) buffer = UNKNOWN;
+	for(GLuint (&unit)[NUM_TEXTURE_TARGETS] : textures) {
+		for(GLuint &texture : unit) texture = UNKNOWN;
+	}
+}
+
+void GLState::set_enabled(const bool enabled) {
+	this->enabled = enabled;
+	invalidate();
+}
+
+unsigned long GLState::get_num_issued() { return num_issued; }
+unsigned long GLState::get_num_elided() { return num_elided; }
+
+void GLState::reset_counters() {
+	num_issued = 0;
+	num_elided = 0;
+}
+
+GLState &gl_state() {
+	static thread_local GLState state;
+	return state;
+}
+
+} // namespace boa
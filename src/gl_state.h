@@ -0,0 +1,84 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <iostream>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Shadow copy of the bindings boa changes most: the current program, vertex
+// array, buffer bindings, active texture unit and each unit's textures. Binds
+// that would not change anything are skipped. Every boa class binds through
+// it; code that calls GL directly must call invalidate() afterwards, or the
+// shadow copy may skip a bind that was needed. Deleting objects through it
+// keeps recycled names from looking bound.
+//
+// There is one shadow copy per thread, not per context. create_window and
+// HeadlessContext::make_current invalidate it when they make a context
+// current; code that switches contexts itself (glfwMakeContextCurrent,
+// eglMakeCurrent) must call invalidate() straight after.
+//
+// Element array buffer bindings belong to the vertex array, so they are
+// forgotten whenever the vertex array changes.
+class GLState {
+private:
+	static const GLuint UNKNOWN = ~0u;
+	static const int NUM_BUFFER_TARGETS = 8;
+	static const int NUM_TEXTURE_TARGETS = 4;
+	static const int MAX_TEXTURE_UNITS = 32;
+
+	GLuint program;
+	GLuint vertex_array;
+	GLuint buffers[NUM_BUFFER_TARGETS];
+	GLuint active_unit;
+	GLuint textures[MAX_TEXTURE_UNITS][NUM_TEXTURE_TARGETS];
+
+	unsigned long num_issued;
+	unsigned long num_elided;
+	bool enabled;
+
+	static int buffer_index(const GLenum target);
+	static int texture_index(const GLenum target);
+
+	bool change(GLuint &shadow, const GLuint value);
+public:
+	GLState();
+	GLState(const GLState&) = delete;
+
+	GLState &operator=(const GLState&) = delete;
+
+	void use_program(const GLuint program);
+	void bind_vertex_array(const GLuint vertex_array);
+	void bind_buffer(const GLenum target, const GLuint buffer);
+	void bind_buffer_base(const GLenum target, const GLuint index, const GLuint buffer); // Also binds the generic target
+	void active_texture(const GLuint unit); // Unit number, not GL_TEXTUREi
+	void bind_texture(const GLenum target, const GLuint texture); // On the active unit
+	void bind_texture(const GLenum target, const GLuint unit, const GLuint texture);
+
+	// Delete objects, forgetting any binding of their names
+	void delete_program(const GLuint program);
+	void delete_vertex_arrays(const GLsizei count, const GLuint *vertex_arrays);
+	void delete_buffers(const GLsizei count, const GLuint *buffers);
+	void delete_textures(const GLsizei count, const GLuint *textures);
+
+	// Forget everything, after GL calls made behind the cache's back
+	void invalidate();
+
+	// With the cache disabled every call is issued, for checking whether a
+	// rendering bug is caused by a stale shadow copy
+	void set_enabled(const bool enabled);
+
+	unsigned long get_num_issued();
+	unsigned long get_num_elided();
+	void reset_counters();
+};
+
+// The state of the context current on this thread
+GLState &gl_state();
+
+} // namespace boa
+
+#endif // GL_STATE_H
@@ -0,0 +1,146 @@
+#include "headless_context.h"
+
+#include <cstring>
+
+#include <EGL/eglext.h>
+
+#include "gl_state.h"
+
+namespace boa {
+
+namespace {
+
+// Extension strings are space separated, and names may prefix each other
+bool has_extension(const char *extensions, const char *name) {
+	if(extensions == nullptr) return false;
+
+	const std::size_t length = std::strlen(name);
+	for(const char *found = std::strstr(extensions, name); found != nullptr; found = std::strstr(found + length, name)) {
+		const bool starts = found == extensions || found[-1] == ' ';
+		const bool ends = found[length] == ' ' || found[length] == '\0';
+		if(starts && ends) return true;
+	}
+	return false;
+}
+
+// Mesa's surfaceless platform if the client library has it, otherwise
+// whatever EGL considers the default
+EGLDisplay open_display() {
+	const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	if(has_extension(client_extensions, "EGL_EXT_platform_base") && has_extension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+		PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+			reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+		if(get_platform_display != nullptr) {
+			EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+			if(display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) return display;
+		}
+	}
+
+	EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if(display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) return display;
+	return EGL_NO_DISPLAY;
+}
+
+} // namespace
+
+HeadlessContext::HeadlessContext(const GLint version_major, const GLint version_minor) {
+	display = open_display();
+	surface = EGL_NO_SURFACE;
+	context = EGL_NO_CONTEXT;
+	if(display == EGL_NO_DISPLAY) {
+		ERROR("No EGL display is available for a headless context");
+		return;
+	}
+
+	const bool surfaceless = has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+	const EGLint config_attributes[] = {
+		EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint num_configs = 0;
+	if(!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, config_attributes, &config, 1, &num_configs) || num_configs == 0) {
+		ERROR("No EGL config supports desktop OpenGL");
+		release();
+		return;
+	}
+
+	const EGLint context_attributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, version_major,
+		EGL_CONTEXT_MINOR_VERSION, version_minor,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+	if(context == EGL_NO_CONTEXT) {
+		ERROR("Failed to create an OpenGL " << version_major << "." << version_minor << " core context");
+		release();
+		return;
+	}
+
+	if(!surfaceless) {
+		const EGLint pbuffer_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+		surface = eglCreatePbufferSurface(display, config, pbuffer_attributes);
+		if(surface == EGL_NO_SURFACE) {
+			ERROR("Failed to create a pbuffer for the headless context");
+			release();
+			return;
+		}
+	}
+
+	if(!make_current()) {
+		release();
+		return;
+	}
+
+	glewExperimental = GL_TRUE;
+	const GLenum status = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	// GLEW built for GLX loads the GL entry points before looking for a GLX display
+	if(status != GLEW_OK && status != GLEW_ERROR_NO_GLX_DISPLAY) {
+#else
+	if(status != GLEW_OK) {
+#endif
+		ERROR("Failed to initialize GLEW for the headless context");
+	}
+}
+
+HeadlessContext::~HeadlessContext() {
+	release();
+}
+
+bool HeadlessContext::make_current() {
+	if(!eglMakeCurrent(display, surface, surface, context)) {
+		ERROR("Failed to make the headless context current");
+		return false;
+	}
+
+	gl_state().invalidate(); // The shadow copy may describe another context
+	return true;
+}
+
+// The display is shared by every context in the process, so it is left
+// initialized
+void HeadlessContext::release() {
+	if(display == EGL_NO_DISPLAY) return;
+
+	if(eglGetCurrentContext() == context) {
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		gl_state().invalidate();
+	}
+	if(context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+	if(surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+
+	display = EGL_NO_DISPLAY;
+	surface = EGL_NO_SURFACE;
+	context = EGL_NO_CONTEXT;
+}
+
+bool HeadlessContext::is_valid() { return context != EGL_NO_CONTEXT; }
+
+} // namespace boa
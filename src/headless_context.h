@@ -0,0 +1,43 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <iostream>
+
+#include <GL/glew.h>
+#include <EGL/egl.h>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Desktop GL core context with no window and no display server, for batch
+// jobs such as thumbnails and server-side previews. EGL is asked for Mesa's
+// surfaceless platform first, which runs on llvmpipe without a GPU or X, and
+// falls back to the default display. Without EGL_KHR_surfaceless_context a
+// 1x1 pbuffer stands in for the window surface. There is no default
+// framebuffer to draw to, so render into a RenderTarget.
+//
+// The constructor makes the context current and initializes GLEW, like
+// init followed by create_window. The context is destroyed by release() or
+// the destructor, after every GL object made in it.
+class HeadlessContext {
+private:
+	EGLDisplay display;
+	EGLSurface surface;
+	EGLContext context;
+public:
+	HeadlessContext(const GLint version_major, const GLint version_minor);
+	HeadlessContext(const HeadlessContext&) = delete;
+	~HeadlessContext();
+
+	HeadlessContext &operator=(const HeadlessContext&) = delete;
+
+	bool make_current(); // On the calling thread
+	void release();
+
+	bool is_valid();
+};
+
+} // namespace boa
+
+#endif // HEADLESS_CONTEXT_H
@@ -0,0 +1,130 @@
+#include "hot_reloader.h"
+
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace boa {
+
+namespace {
+
+std::string directory_of(const std::string &path) {
+	const std::size_t slash = path.find_last_of('/');
+	return slash == std::string::npos ? "." : path.substr(0, slash);
+}
+
+// Paths are compared with the directory plus file name reported by inotify
+std::string watch_path(const std::string &path) {
+	return path.find('/') == std::string::npos ? "./" + path : path;
+}
+
+} // namespace
+
+HotReloader::HotReloader(ProgramBuilder &builder) : builder(builder) {
+#ifdef __linux__
+	inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(inotify_fd < 0) ERROR("Could not start watching shader files");
+#else
+	inotify_fd = -1;
+#endif
+}
+
+HotReloader::~HotReloader() {
+	if(inotify_fd >= 0) close(inotify_fd);
+}
+
+// Watch directories rather than files: editors often save by writing a new
+// file and renaming it over the old one, which ends a watch on the file itself
+void HotReloader::watch_directory(const std::string &path) {
+#ifdef __linux__
+	if(inotify_fd < 0) return;
+
+	const std::string directory = directory_of(path);
+	for(const auto &entry : watched_directories) {
+		if(entry.second == directory) return;
+	}
+
+	const int descriptor = inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if(descriptor < 0) {
+		ERROR("Could not watch " << directory);
+		return;
+	}
+	watched_directories[descriptor] = directory;
+#endif
+}
+
+void HotReloader::watch(Program &program, const std::string &vertex_path, const std::string &fragment_path) {
+	watches.push_back({&program, watch_path(vertex_path), watch_path(fragment_path), -1, false});
+	watch_directory(vertex_path);
+	watch_directory(fragment_path);
+}
+
+void HotReloader::unwatch(Program &program) {
+	for(std::size_t i = 0; i < watches.size(); ++i) {
+		if(watches[i].program != &program) continue;
+
+		if(watches[i].ticket >= 0) builder.cancel(watches[i].ticket);
+		watches.erase(watches.begin() + i);
+		return;
+	}
+}
+
+void HotReloader::file_changed(const std::string &path) {
+	for(Watch &watch : watches) {
+		if(watch.vertex_path != path && watch.fragment_path != path) continue;
+
+		if(watch.ticket >= 0) {
+			watch.stale = true; // Rebuild again once the pending one is done
+		} else {
+			DEBUG("Reloading " << watch.vertex_path << " + " << watch.fragment_path);
+			watch.ticket = builder.request(watch.vertex_path.c_str(), watch.fragment_path.c_str());
+		}
+	}
+}
+
+int HotReloader::update() {
+#ifdef __linux__
+	if(inotify_fd >= 0) {
+		alignas(inotify_event) char buffer[4096];
+		while(true) {
+			const ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+			if(length <= 0) break; // EAGAIN: nothing more to read
+
+			for(ssize_t offset = 0; offset < length; ) {
+				const inotify_event *event = reinterpret_cast<const inotify_event*>(buffer + offset);
+				offset += sizeof(inotify_event) + event->len;
+
+				const auto directory = watched_directories.find(event->wd);
+				if(directory == watched_directories.end() || event->len == 0) continue;
+				file_changed(directory->second + "/" + event->name);
+			}
+		}
+	}
+#endif
+
+	builder.poll();
+
+	int num_replaced = 0;
+	for(Watch &watch : watches) {
+		if(watch.ticket < 0 || !builder.is_ready(watch.ticket)) continue;
+
+		const bool linked = builder.is_linked(watch.ticket);
+		Program program = builder.take(watch.ticket);
+		watch.ticket = -1;
+		if(linked) {
+			*watch.program = std::move(program);
+			++num_replaced;
+		}
+
+		if(watch.stale) {
+			watch.stale = false;
+			watch.ticket = builder.request(watch.vertex_path.c_str(), watch.fragment_path.c_str());
+		}
+	}
+
+	return num_replaced;
+}
+
+} // namespace boa
@@ -0,0 +1,54 @@
+#ifndef HOT_RELOADER_H
+#define HOT_RELOADER_H
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "boa_global.h"
+#include "program.h"
+#include "program_builder.h"
+
+namespace boa {
+
+// Rebuilds programs when their shader files change on disk. Changes are
+// picked up with inotify and rebuilt through a ProgramBuilder, and the new
+// program replaces the old one only once it has linked, so a frame never
+// waits on the compiler and a broken edit keeps the last good program.
+// Watched programs must stay at the same address while watched.
+class HotReloader {
+private:
+	struct Watch {
+		Program *program;
+		std::string vertex_path;
+		std::string fragment_path;
+		int ticket; // Pending rebuild, or -1
+		bool stale; // Changed again while a rebuild was pending
+	};
+
+	ProgramBuilder &builder;
+	std::vector<Watch> watches;
+	std::unordered_map<int, std::string> watched_directories; // inotify watch descriptor to directory
+	int inotify_fd;
+
+	void watch_directory(const std::string &path);
+	void file_changed(const std::string &path);
+public:
+	HotReloader(ProgramBuilder &builder);
+	HotReloader(const HotReloader&) = delete;
+	~HotReloader();
+
+	HotReloader &operator=(const HotReloader&) = delete;
+
+	void watch(Program &program, const std::string &vertex_path, const std::string &fragment_path);
+	void unwatch(Program &program);
+
+	// Check for changed files, start rebuilds and swap in finished programs.
+	// Returns how many programs were replaced. Call once per frame.
+	int update();
+};
+
+} // namespace boa
+
+#endif // HOT_RELOADER_H
@@ -0,0 +1,117 @@
+#include "instanced_mesh.h"
+
+#include "gl_state.h"
+#include "profiler.h"
+
+namespace boa {
+
+InstancedMesh::InstancedMesh(GLData &data, AttributeSetup attribute_setup, const GLuint instance_location, const MeshUsage usage)
+	: mesh(data, attribute_setup, usage) {
+	instance_vbo = 0;
+	this->instance_location = instance_location;
+	instance_capacity = 0;
+	num_instances = 0;
+
+	glGenBuffers(1, &instance_vbo);
+	set_instance_pointers();
+}
+
+InstancedMesh::InstancedMesh(InstancedMesh &&other) : mesh(std::move(other.mesh)) {
+	instance_vbo = other.instance_vbo;
+	instance_location = other.instance_location;
+	instance_capacity = other.instance_capacity;
+	num_instances = other.num_instances;
+
+	other.instance_vbo = 0;
+	other.instance_capacity = 0;
+	other.num_instances = 0;
+}
+
+InstancedMesh &InstancedMesh::operator=(InstancedMesh &&other) {
+	if(this == &other) return *this;
+
+	release();
+	mesh = std::move(other.mesh);
+	instance_vbo = other.instance_vbo;
+	instance_location = other.instance_location;
+	instance_capacity = other.instance_capacity;
+	num_instances = other.num_instances;
+
+	other.instance_vbo = 0;
+	other.instance_capacity = 0;
+	other.num_instances = 0;
+
+	return *this;
+}
+
+InstancedMesh::~InstancedMesh() {
+	release();
+}
+
+// Attach the instance buffer to the mesh's vertex array, advancing once per instance
+void InstancedMesh::set_instance_pointers() {
+	gl_state().bind_vertex_array(mesh.get_vao());
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, instance_vbo);
+
+	glVertexAttribPointer(instance_location, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (GLvoid*) offsetof(Instance, transform));
+	glEnableVertexAttribArray(instance_location);
+	glVertexAttribDivisor(instance_location, 1);
+
+	glVertexAttribPointer(instance_location + 1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (GLvoid*) offsetof(Instance, tint));
+	glEnableVertexAttribArray(instance_location + 1);
+	glVertexAttribDivisor(instance_location + 1, 1);
+
+	gl_state().bind_vertex_array(0);
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstancedMesh::set_instances(const Instance *instances, const int num_instances) {
+	this->num_instances = num_instances;
+	if(num_instances == 0) return;
+
+	if(num_instances > instance_capacity) instance_capacity = std::max(num_instances, instance_capacity * 2);
+
+	// Respecifying the storage orphans whatever the last draw may still be reading
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, instance_vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(Instance) * instance_capacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Instance) * num_instances, instances);
+	PROFILE_UPLOAD(sizeof(Instance) * num_instances);
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstancedMesh::set_instances(const std::vector<Instance> &instances) {
+	set_instances(instances.data(), instances.size());
+}
+
+void InstancedMesh::update_instances(const int first_instance, const Instance *instances, const int num_instances) {
+	if(first_instance < 0 || first_instance + num_instances > this->num_instances) {
+		ERROR("Instances " << first_instance << " to " << first_instance + num_instances << " are out of range of " << this->num_instances);
+		return;
+	}
+
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, instance_vbo);
+	glBufferSubData(GL_ARRAY_BUFFER, sizeof(Instance) * first_instance, sizeof(Instance) * num_instances, instances);
+	PROFILE_UPLOAD(sizeof(Instance) * num_instances);
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstancedMesh::draw() {
+	if(num_instances == 0) return;
+
+	gl_state().bind_vertex_array(mesh.get_vao());
+	glDrawElementsInstanced(GL_TRIANGLES, mesh.get_num_elements(), GL_UNSIGNED_INT, 0, num_instances);
+	PROFILE_DRAW(mesh.get_num_elements() / 3 * num_instances);
+}
+
+void InstancedMesh::release() {
+	mesh.release();
+	if(instance_vbo != 0) gl_state().delete_buffers(1, &instance_vbo);
+	instance_vbo = 0;
+	instance_capacity = 0;
+	num_instances = 0;
+}
+
+Mesh &InstancedMesh::get_mesh() { return mesh; }
+int InstancedMesh::get_num_instances() { return num_instances; }
+
+} // namespace boa
@@ -0,0 +1,63 @@
+#ifndef INSTANCED_MESH_H
+#define INSTANCED_MESH_H
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "boa_global.h"
+#include "gl_data.h"
+#include "mesh.h"
+
+namespace boa {
+
+// Per-instance attributes, read by the instanced vertex shader as two vec4s
+// at consecutive locations.
+struct Instance {
+	glm::vec4 transform; // x and y translation, rotation in radians, uniform scale
+	glm::vec4 tint; // Multiplies the vertex color
+};
+
+// One mesh drawn many times with glDrawElementsInstanced, each copy placed
+// and tinted by an entry in a per-instance buffer. The instance buffer is
+// rewritten every time set_instances is called; its old storage is orphaned
+// first so the driver never has to wait for the previous frame's draw.
+class InstancedMesh {
+private:
+	Mesh mesh;
+	GLuint instance_vbo;
+	GLuint instance_location; // Location of transform; tint follows it
+	int instance_capacity;
+	int num_instances;
+
+	void set_instance_pointers();
+public:
+	InstancedMesh(GLData &data, AttributeSetup attribute_setup, const GLuint instance_location, const MeshUsage usage = MeshUsage::STATIC);
+	template<typename... Attributes> InstancedMesh(TypedGLData<Attributes...> &data, const MeshUsage usage = MeshUsage::STATIC)
+		: InstancedMesh(data, &TypedGLData<Attributes...>::set_attribute_pointers, sizeof...(Attributes), usage) {}
+	InstancedMesh(const InstancedMesh&) = delete;
+	InstancedMesh(InstancedMesh &&other);
+	~InstancedMesh();
+
+	InstancedMesh &operator=(const InstancedMesh&) = delete;
+	InstancedMesh &operator=(InstancedMesh &&other);
+
+	// Replace every instance, growing the buffer if needed
+	void set_instances(const Instance *instances, const int num_instances);
+	void set_instances(const std::vector<Instance> &instances);
+
+	// Overwrite some of the current instances without orphaning the buffer
+	void update_instances(const int first_instance, const Instance *instances, const int num_instances);
+
+	void draw();
+	void release();
+
+	Mesh &get_mesh();
+	int get_num_instances();
+};
+
+} // namespace boa
+
+#endif // INSTANCED_MESH_H
@@ -0,0 +1,66 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace boa {
+
+MappedFile::MappedFile(const char *path) {
+	data = nullptr;
+	size = 0;
+
+	const int fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		ERROR("File " << path << " could not be opened");
+		return;
+	}
+
+	struct stat info;
+	if(fstat(fd, &info) == 0 && info.st_size > 0) {
+		void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(mapping != MAP_FAILED) {
+			data = static_cast<const unsigned char*>(mapping);
+			size = info.st_size;
+			madvise(mapping, size, MADV_WILLNEED);
+		}
+	}
+	close(fd); // The mapping keeps the file alive
+
+	if(data == nullptr) ERROR("File " << path << " could not be mapped");
+}
+
+MappedFile::MappedFile(MappedFile &&other) {
+	data = other.data;
+	size = other.size;
+	other.data = nullptr;
+	other.size = 0;
+}
+
+MappedFile::~MappedFile() {
+	release();
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) {
+	if(this != &other) {
+		release();
+		data = other.data;
+		size = other.size;
+		other.data = nullptr;
+		other.size = 0;
+	}
+	return *this;
+}
+
+void MappedFile::release() {
+	if(data != nullptr) munmap(const_cast<unsigned char*>(data), size);
+	data = nullptr;
+	size = 0;
+}
+
+bool MappedFile::is_open() { return data != nullptr; }
+const unsigned char *MappedFile::get_data() { return data; }
+std::size_t MappedFile::get_size() { return size; }
+
+} // namespace boa
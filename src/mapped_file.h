@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <iostream>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first
+// touch, so handing get_data() to an upload reads the file straight from the
+// page cache without staging it in a heap buffer.
+class MappedFile {
+private:
+	const unsigned char *data;
+	std::size_t size;
+public:
+	MappedFile(const char *path);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile &&other);
+	~MappedFile();
+
+	MappedFile &operator=(const MappedFile&) = delete;
+	MappedFile &operator=(MappedFile &&other);
+
+	void release();
+
+	bool is_open();
+	const unsigned char *get_data();
+	std::size_t get_size();
+};
+
+} // namespace boa
+
+#endif // MAPPED_FILE_H
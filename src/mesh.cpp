@@ -0,0 +1,221 @@
+#include "mesh.h"
+
+#include "gl_state.h"
+#include "profiler.h"
+
+namespace boa {
+
+Mesh::Mesh(GLData &data, AttributeSetup attribute_setup, const MeshUsage usage) {
+	vao = 0;
+	vbo = 0;
+	ibo = 0;
+	verts_capacity = 0;
+	indices_capacity = 0;
+	num_elements = 0;
+	stride = data.get_stride();
+	this->usage = usage;
+	this->attribute_setup = attribute_setup;
+	immutable = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+
+	glGenVertexArrays(1, &vao);
+	upload(data);
+}
+
+Mesh::Mesh(MeshFile &file, const MeshUsage usage) {
+	vao = 0;
+	vbo = 0;
+	ibo = 0;
+	verts_capacity = 0;
+	indices_capacity = 0;
+	num_elements = 0;
+	stride = file.is_valid() ? file.get_stride() : 0;
+	this->usage = usage;
+	attribute_setup = nullptr;
+	immutable = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+
+	glGenVertexArrays(1, &vao);
+	if(!file.is_valid()) {
+		ERROR("Cannot create a mesh from an invalid mesh file");
+		return;
+	}
+	attributes = file.get_attributes();
+	upload(file.get_vertices(), file.get_verts_size(), file.get_indices(), file.get_indices_size(), file.get_num_elements());
+}
+
+Mesh::Mesh(Mesh &&other) {
+	vao = 0;
+	vbo = 0;
+	ibo = 0;
+	*this = std::move(other);
+}
+
+Mesh &Mesh::operator=(Mesh &&other) {
+	if(this == &other) return *this;
+
+	release();
+	vao = other.vao;
+	vbo = other.vbo;
+	ibo = other.ibo;
+	verts_capacity = other.verts_capacity;
+	indices_capacity = other.indices_capacity;
+	num_elements = other.num_elements;
+	stride = other.stride;
+	usage = other.usage;
+	attribute_setup = other.attribute_setup;
+	attributes = std::move(other.attributes);
+	immutable = other.immutable;
+
+	other.vao = 0;
+	other.vbo = 0;
+	other.ibo = 0;
+	other.verts_capacity = 0;
+	other.indices_capacity = 0;
+	other.num_elements = 0;
+
+	return *this;
+}
+
+Mesh::~Mesh() {
+	release();
+}
+
+// Create a new buffer of size bytes holding data. Immutable storage cannot be
+// resized, so the old buffer is always replaced rather than reallocated.
+void Mesh::allocate(const GLenum target, GLuint &buffer, const int size, const void *data) {
+	if(buffer != 0) gl_state().delete_buffers(1, &buffer);
+	glGenBuffers(1, &buffer);
+	gl_state().bind_buffer(target, buffer);
+
+	if(immutable) {
+		glBufferStorage(target, size, data, usage == MeshUsage::DYNAMIC ? GL_DYNAMIC_STORAGE_BIT : 0);
+	} else {
+		glBufferData(target, size, data, usage == MeshUsage::DYNAMIC ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+	}
+	PROFILE_UPLOAD(data != nullptr ? size : 0);
+}
+
+void Mesh::set_attribute_pointers() {
+	if(attribute_setup != nullptr) {
+		attribute_setup(0);
+		return;
+	}
+
+	for(std::size_t i = 0; i < attributes.size(); ++i) {
+		glVertexAttribPointer(i, attributes[i].size, GL_FLOAT, attributes[i].normalized,
+			stride * sizeof(GLfloat), (GLvoid*) (attributes[i].offset * sizeof(GLfloat)));
+		glEnableVertexAttribArray(i);
+	}
+}
+
+void Mesh::upload(GLData &data) {
+	if(data.get_stride() != stride) {
+		ERROR("Cannot upload GLData with a stride of " << data.get_stride() << " to a mesh with a stride of " << stride);
+		return;
+	}
+
+	upload(data.get_vertices(), data.get_verts_size(), data.get_indices(), data.get_indices_size(), data.get_num_elements());
+}
+
+void Mesh::upload(const GLfloat *vertices, const int verts_size, const GLuint *indices, const int indices_size, const int num_elements) {
+	gl_state().bind_vertex_array(vao);
+
+	// Reuse buffers that are big enough, unless their storage cannot be written
+	const bool writable = !immutable || usage == MeshUsage::DYNAMIC;
+	if(vbo != 0 && writable && verts_size <= verts_capacity) {
+		gl_state().bind_buffer(GL_ARRAY_BUFFER, vbo);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, verts_size, vertices);
+		PROFILE_UPLOAD(verts_size);
+	} else {
+		allocate(GL_ARRAY_BUFFER, vbo, verts_size, vertices);
+		verts_capacity = verts_size;
+		set_attribute_pointers();
+	}
+
+	// The element buffer binding is part of the vertex array state
+	if(ibo != 0 && writable && indices_size <= indices_capacity) {
+		gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices_size, indices);
+		PROFILE_UPLOAD(indices_size);
+	} else {
+		allocate(GL_ELEMENT_ARRAY_BUFFER, ibo, indices_size, indices);
+		indices_capacity = indices_size;
+	}
+	this->num_elements = num_elements;
+
+	gl_state().bind_vertex_array(0);
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool Mesh::check_updatable(const int offset, const int size, const int capacity) const {
+	if(immutable && usage != MeshUsage::DYNAMIC) {
+		ERROR("Cannot update a static mesh in place; use MeshUsage::DYNAMIC or upload()");
+		return false;
+	}
+	if(offset < 0 || offset + size > capacity) {
+		ERROR("Mesh update of " << size << " bytes at " << offset << " exceeds the " << capacity << " byte buffer");
+		return false;
+	}
+
+	return true;
+}
+
+void Mesh::update_vertices(GLData &data, const int first_vertex, const int num_verts) {
+	const int offset = sizeof(GLfloat) * first_vertex * stride;
+	const int size = sizeof(GLfloat) * num_verts * stride;
+	if(num_verts <= 0 || !check_updatable(offset, size, verts_capacity)) return;
+
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, vbo);
+	glBufferSubData(GL_ARRAY_BUFFER, offset, size, data.get_vertices() + first_vertex * stride);
+	PROFILE_UPLOAD(size);
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::update_indices(GLData &data, const int first_index, const int num_indices) {
+	const int offset = sizeof(GLuint) * first_index;
+	const int size = sizeof(GLuint) * num_indices;
+	if(num_indices <= 0 || !check_updatable(offset, size, indices_capacity)) return;
+
+	// Binding the element buffer outside a vertex array would change the default one's state
+	gl_state().bind_vertex_array(vao);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data.get_indices() + first_index);
+	PROFILE_UPLOAD(size);
+	gl_state().bind_vertex_array(0);
+}
+
+void Mesh::update(GLData &data, const UpdateResult result) {
+	// Static immutable buffers can only be replaced
+	if((immutable && usage != MeshUsage::DYNAMIC) || data.get_num_elements() != num_elements) {
+		upload(data);
+		return;
+	}
+
+	update_vertices(data, 0, data.get_num_verts());
+	if(result != UpdateResult::VERTICES_ONLY) update_indices(data, 0, data.get_num_elements());
+}
+
+void Mesh::draw() {
+	// Left bound, so drawing the same mesh again skips the bind
+	gl_state().bind_vertex_array(vao);
+	glDrawElements(GL_TRIANGLES, num_elements, GL_UNSIGNED_INT, 0);
+	PROFILE_DRAW(num_elements / 3);
+}
+
+void Mesh::release() {
+	if(vao != 0) gl_state().delete_vertex_arrays(1, &vao);
+	if(vbo != 0) gl_state().delete_buffers(1, &vbo);
+	if(ibo != 0) gl_state().delete_buffers(1, &ibo);
+	vao = 0;
+	vbo = 0;
+	ibo = 0;
+	verts_capacity = 0;
+	indices_capacity = 0;
+	num_elements = 0;
+}
+
+GLuint Mesh::get_vao() { return vao; }
+GLuint Mesh::get_vbo() { return vbo; }
+GLuint Mesh::get_ibo() { return ibo; }
+int Mesh::get_num_elements() { return num_elements; }
+bool Mesh::is_immutable() { return immutable; }
+
+} // namespace boa
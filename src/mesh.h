@@ -0,0 +1,85 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+#include "gl_data.h"
+#include "mesh_file.h"
+#include "vertex_format.h"
+
+namespace boa {
+
+// How often a mesh's buffers are expected to change
+enum class MeshUsage {
+	STATIC, // Uploaded once; immutable storage without update access
+	DYNAMIC // Updated in place with update_vertices and update_indices
+};
+
+// Describes the vertex layout to the bound vertex array, starting at a location
+using AttributeSetup = void (*)(GLuint first_location);
+
+// Vertex array with its own vertex and index buffers, uploaded from a GLData
+// or a baked MeshFile. Buffers use immutable storage (glBufferStorage) when
+// the context supports it, and are reallocated only when a new upload no
+// longer fits. All GL objects are deleted by release() or the destructor, so
+// a Mesh must not outlive its context.
+class Mesh {
+private:
+	GLuint vao;
+	GLuint vbo;
+	GLuint ibo;
+
+	int verts_capacity; // Bytes allocated in vbo
+	int indices_capacity; // Bytes allocated in ibo
+	int num_elements;
+	int stride; // GLfloats per vertex
+
+	MeshUsage usage;
+	AttributeSetup attribute_setup;
+	std::vector<VertexAttribute> attributes; // Used instead of attribute_setup when loaded from a file
+	bool immutable;
+
+	void allocate(const GLenum target, GLuint &buffer, const int size, const void *data);
+	void set_attribute_pointers();
+	void upload(const GLfloat *vertices, const int verts_size, const GLuint *indices, const int indices_size, const int num_elements);
+	bool check_updatable(const int offset, const int size, const int capacity) const;
+public:
+	Mesh(GLData &data, AttributeSetup attribute_setup, const MeshUsage usage = MeshUsage::STATIC);
+	template<typename... Attributes> Mesh(TypedGLData<Attributes...> &data, const MeshUsage usage = MeshUsage::STATIC)
+		: Mesh(data, &TypedGLData<Attributes...>::set_attribute_pointers, usage) {}
+	// Upload straight from a mapped mesh file, laid out as the file describes
+	Mesh(MeshFile &file, const MeshUsage usage = MeshUsage::STATIC);
+	Mesh(const Mesh&) = delete;
+	Mesh(Mesh &&other);
+	~Mesh();
+
+	Mesh &operator=(const Mesh&) = delete;
+	Mesh &operator=(Mesh &&other);
+
+	// Replace both buffers with data, growing them if needed
+	void upload(GLData &data);
+
+	// Upload part of data's vertex or index array to the same place in the buffers
+	void update_vertices(GLData &data, const int first_vertex, const int num_verts);
+	void update_indices(GLData &data, const int first_index, const int num_indices);
+
+	// Upload what GLData::update_vertices changed: always the vertices, and the
+	// indices only if triangles were rebuilt
+	void update(GLData &data, const UpdateResult result);
+
+	void draw();
+	void release();
+
+	GLuint get_vao();
+	GLuint get_vbo();
+	GLuint get_ibo();
+	int get_num_elements();
+	bool is_immutable();
+};
+
+} // namespace boa
+
+#endif // MESH_H
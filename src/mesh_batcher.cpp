@@ -0,0 +1,270 @@
+#include "mesh_batcher.h"
+
+#include <numeric>
+
+#include "gl_state.h"
+#include "profiler.h"
+
+namespace boa {
+
+RangeAllocator::RangeAllocator(const int capacity) : capacity(capacity) {
+	if(capacity > 0) free_ranges[0] = capacity;
+}
+
+int RangeAllocator::allocate(const int size) {
+	for(auto it = free_ranges.begin(); it != free_ranges.end(); ++it) {
+		if(it->second < size) continue;
+
+		const int offset = it->first;
+		const int remaining = it->second - size;
+		free_ranges.erase(it);
+		if(remaining > 0) free_ranges[offset + size] = remaining;
+		return offset;
+	}
+
+	return -1;
+}
+
+void RangeAllocator::release(const int offset, const int size) {
+	if(size <= 0) return;
+
+	int start = offset;
+	int end = offset + size;
+	auto next = free_ranges.lower_bound(offset);
+	if(next != free_ranges.end() && next->first == end) {
+		end += next->second;
+		next = free_ranges.erase(next);
+	}
+	if(next != free_ranges.begin()) {
+		auto prev = std::prev(next);
+		if(prev->first + prev->second == start) {
+			start = prev->first;
+			free_ranges.erase(prev);
+		}
+	}
+
+	free_ranges[start] = end - start;
+}
+
+void RangeAllocator::grow(const int capacity) {
+	if(capacity <= this->capacity) return;
+
+	release(this->capacity, capacity - this->capacity);
+	this->capacity = capacity;
+}
+
+int RangeAllocator::get_capacity() { return capacity; }
+
+MeshBatcher::MeshBatcher(const int stride, AttributeSetup attribute_setup, const int verts_capacity, const int indices_capacity)
+	: vertex_ranges(verts_capacity), index_ranges(indices_capacity) {
+	vao = 0;
+	vbo = 0;
+	ibo = 0;
+	this->stride = stride;
+	this->attribute_setup = attribute_setup;
+	immutable = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+	num_meshes = 0;
+	groups_dirty = true;
+
+	allocate(vbo, sizeof(GLfloat) * verts_capacity * stride);
+	allocate(ibo, sizeof(GLuint) * indices_capacity);
+
+	glGenVertexArrays(1, &vao);
+	gl_state().bind_vertex_array(vao);
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, vbo);
+	attribute_setup(0);
+	gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	gl_state().bind_vertex_array(0);
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+MeshBatcher::~MeshBatcher() {
+	release();
+}
+
+// Create an empty buffer that can be written with glBufferSubData. The copy
+// binding points leave the vertex array and array buffer bindings alone.
+void MeshBatcher::allocate(GLuint &buffer, const int size) {
+	glGenBuffers(1, &buffer);
+	gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, buffer);
+	if(immutable) glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+	else glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// Find room for count elements, doubling the buffer if nothing fits
+int MeshBatcher::place(RangeAllocator &ranges, const GLenum target, GLuint &buffer, const int element_size, const int count) {
+	int offset = ranges.allocate(count);
+	if(offset >= 0) return offset;
+
+	const int old_capacity = ranges.get_capacity();
+	const int new_capacity = std::max(old_capacity * 2, old_capacity + count);
+	DEBUG("Growing batch buffer from " << old_capacity << " to " << new_capacity << " elements");
+
+	GLuint old_buffer = buffer;
+	allocate(buffer, element_size * new_capacity);
+	gl_state().bind_buffer(GL_COPY_READ_BUFFER, old_buffer);
+	gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, element_size * old_capacity);
+	gl_state().bind_buffer(GL_COPY_READ_BUFFER, 0);
+	gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, 0);
+	gl_state().delete_buffers(1, &old_buffer);
+
+	// Point the vertex array at the new buffer
+	gl_state().bind_vertex_array(vao);
+	gl_state().bind_buffer(target, buffer);
+	if(target == GL_ARRAY_BUFFER) {
+		attribute_setup(0);
+		gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+	}
+	gl_state().bind_vertex_array(0);
+
+	ranges.grow(new_capacity);
+	return ranges.allocate(count);
+}
+
+void MeshBatcher::upload(const Entry &entry, GLData &data) {
+	gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, vbo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(GLfloat) * entry.base_vertex * stride, data.get_verts_size(), data.get_vertices());
+	gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, ibo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * entry.first_index, data.get_indices_size(), data.get_indices());
+	PROFILE_UPLOAD(data.get_verts_size() + data.get_indices_size());
+	gl_state().bind_buffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+int MeshBatcher::add(GLData &data, const GLuint program) {
+	if(data.get_stride() != stride) {
+		ERROR("Cannot batch GLData with a stride of " << data.get_stride() << " with a stride of " << stride);
+		return -1;
+	}
+
+	int handle;
+	if(!free_handles.empty()) {
+		handle = free_handles.back();
+		free_handles.pop_back();
+	} else {
+		handle = entries.size();
+		entries.emplace_back();
+	}
+
+	Entry &entry = entries[handle];
+	entry.program = program;
+	entry.num_verts = data.get_num_verts();
+	entry.num_elements = data.get_num_elements();
+	entry.base_vertex = place(vertex_ranges, GL_ARRAY_BUFFER, vbo, sizeof(GLfloat) * stride, entry.num_verts);
+	entry.first_index = place(index_ranges, GL_ELEMENT_ARRAY_BUFFER, ibo, sizeof(GLuint), entry.num_elements);
+	entry.alive = true;
+	upload(entry, data);
+
+	++num_meshes;
+	groups_dirty = true;
+	return handle;
+}
+
+void MeshBatcher::remove(const int handle) {
+	if(handle < 0 || handle >= (int) entries.size() || !entries[handle].alive) {
+		ERROR("No batched mesh with handle " << handle);
+		return;
+	}
+
+	Entry &entry = entries[handle];
+	vertex_ranges.release(entry.base_vertex, entry.num_verts);
+	index_ranges.release(entry.first_index, entry.num_elements);
+	entry.alive = false;
+	free_handles.push_back(handle);
+
+	--num_meshes;
+	groups_dirty = true;
+}
+
+void MeshBatcher::update(const int handle, GLData &data) {
+	if(handle < 0 || handle >= (int) entries.size() || !entries[handle].alive) {
+		ERROR("No batched mesh with handle " << handle);
+		return;
+	}
+
+	Entry &entry = entries[handle];
+	if(data.get_num_verts() != entry.num_verts || data.get_num_elements() != entry.num_elements) {
+		vertex_ranges.release(entry.base_vertex, entry.num_verts);
+		index_ranges.release(entry.first_index, entry.num_elements);
+		entry.num_verts = data.get_num_verts();
+		entry.num_elements = data.get_num_elements();
+		entry.base_vertex = place(vertex_ranges, GL_ARRAY_BUFFER, vbo, sizeof(GLfloat) * stride, entry.num_verts);
+		entry.first_index = place(index_ranges, GL_ELEMENT_ARRAY_BUFFER, ibo, sizeof(GLuint), entry.num_elements);
+		groups_dirty = true;
+	}
+
+	upload(entry, data);
+}
+
+// Gather the draw parameters of every live mesh, grouped by program
+void MeshBatcher::build_groups() {
+	static thread_local std::vector<int> order;
+	order.clear();
+	for(int i = 0; i < (int) entries.size(); ++i) {
+		if(entries[i].alive) order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [&] (const int lhs, const int rhs) {
+		return entries[lhs].program < entries[rhs].program;
+	});
+
+	// Keep the per-group vectors around so their storage is reused
+	int num_groups = 0;
+	for(const int i : order) {
+		const Entry &entry = entries[i];
+		if(num_groups == 0 || groups[num_groups - 1].program != entry.program) {
+			if(num_groups == (int) groups.size()) groups.emplace_back();
+			DrawGroup &group = groups[num_groups++];
+			group.program = entry.program;
+			group.counts.clear();
+			group.offsets.clear();
+			group.base_vertices.clear();
+		}
+
+		DrawGroup &group = groups[num_groups - 1];
+		group.counts.push_back(entry.num_elements);
+		group.offsets.push_back((const GLvoid*) (sizeof(GLuint) * entry.first_index));
+		group.base_vertices.push_back(entry.base_vertex);
+	}
+	groups.resize(num_groups);
+
+	groups_dirty = false;
+}
+
+void MeshBatcher::draw(const std::function<void(GLuint program)> &setup) {
+	if(groups_dirty) build_groups();
+
+	gl_state().bind_vertex_array(vao);
+	for(const DrawGroup &group : groups) {
+		gl_state().use_program(group.program);
+		if(setup) setup(group.program);
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, group.counts.data(), GL_UNSIGNED_INT, group.offsets.data(),
+			group.counts.size(), group.base_vertices.data());
+		PROFILE_DRAW(std::accumulate(group.counts.begin(), group.counts.end(), 0) / 3);
+	}
+}
+
+void MeshBatcher::release() {
+	if(vao != 0) gl_state().delete_vertex_arrays(1, &vao);
+	if(vbo != 0) gl_state().delete_buffers(1, &vbo);
+	if(ibo != 0) gl_state().delete_buffers(1, &ibo);
+	vao = 0;
+	vbo = 0;
+	ibo = 0;
+	entries.clear();
+	free_handles.clear();
+	groups.clear();
+	num_meshes = 0;
+	groups_dirty = true;
+}
+
+int MeshBatcher::get_num_meshes() { return num_meshes; }
+
+int MeshBatcher::get_num_draw_calls() {
+	if(groups_dirty) build_groups();
+	return groups.size();
+}
+
+GLuint MeshBatcher::get_vao() { return vao; }
+
+} // namespace boa
@@ -0,0 +1,104 @@
+#ifndef MESH_BATCHER_H
+#define MESH_BATCHER_H
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+#include "gl_data.h"
+#include "mesh.h"
+
+namespace boa {
+
+// First-fit allocator of ranges in [0, capacity). Released ranges are merged
+// with free neighbours so the arena does not fragment into unusable slivers.
+class RangeAllocator {
+private:
+	std::map<int, int> free_ranges; // Offset to size
+	int capacity;
+
+public:
+	RangeAllocator(const int capacity);
+
+	int allocate(const int size); // Returns the offset, or -1 if nothing fits
+	void release(const int offset, const int size);
+	void grow(const int capacity);
+
+	int get_capacity();
+};
+
+// Packs many small meshes into one shared vertex buffer and index buffer and
+// draws them with one glMultiDrawElementsBaseVertex call per program. Meshes
+// can be added and removed at any time; removed ranges are reused by later
+// meshes and the buffers double in size when nothing fits. Every mesh must
+// share the batcher's vertex layout.
+class MeshBatcher {
+private:
+	struct Entry {
+		GLuint program;
+		int base_vertex;
+		int num_verts;
+		int first_index;
+		int num_elements;
+		bool alive;
+	};
+
+	struct DrawGroup {
+		GLuint program;
+		std::vector<GLsizei> counts;
+		std::vector<const GLvoid*> offsets;
+		std::vector<GLint> base_vertices;
+	};
+
+	GLuint vao;
+	GLuint vbo;
+	GLuint ibo;
+
+	int stride; // GLfloats per vertex
+	AttributeSetup attribute_setup;
+	bool immutable;
+
+	RangeAllocator vertex_ranges; // In vertices
+	RangeAllocator index_ranges; // In indices
+
+	std::vector<Entry> entries;
+	std::vector<int> free_handles;
+	int num_meshes;
+
+	std::vector<DrawGroup> groups;
+	bool groups_dirty;
+
+	void allocate(GLuint &buffer, const int size);
+	int place(RangeAllocator &ranges, const GLenum target, GLuint &buffer, const int element_size, const int count);
+	void upload(const Entry &entry, GLData &data);
+	void build_groups();
+public:
+	MeshBatcher(const int stride, AttributeSetup attribute_setup, const int verts_capacity = 1 << 16, const int indices_capacity = 1 << 18);
+	MeshBatcher(const MeshBatcher&) = delete;
+	~MeshBatcher();
+
+	MeshBatcher &operator=(const MeshBatcher&) = delete;
+
+	// Copy data into the shared buffers, returning a handle for update and remove
+	int add(GLData &data, const GLuint program);
+	void remove(const int handle);
+
+	// Re-upload a mesh, moving it if its size changed
+	void update(const int handle, GLData &data);
+
+	// Draw every mesh, one multi-draw per program. setup, if given, runs after
+	// each program is bound, so per-program uniforms can be set there.
+	void draw(const std::function<void(GLuint program)> &setup = nullptr);
+	void release();
+
+	int get_num_meshes();
+	int get_num_draw_calls(); // Multi-draws issued by draw()
+	GLuint get_vao();
+};
+
+} // namespace boa
+
+#endif // MESH_BATCHER_H
@@ -0,0 +1,113 @@
+#include "mesh_file.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace boa {
+
+bool write_mesh_file(GLData &data, const std::vector<VertexAttribute> &attributes, const char *destination) {
+	MeshFileHeader header;
+	std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+	header.version = MESH_FILE_VERSION;
+	header.stride = data.get_stride();
+	header.num_attributes = attributes.size();
+	header.num_verts = data.get_num_verts();
+	header.num_elements = data.get_num_elements();
+
+	const std::uint64_t table_end = sizeof(header) + attributes.size() * sizeof(MeshFileAttribute);
+	header.vertices_offset = (table_end + 15) & ~static_cast<std::uint64_t>(15);
+	header.indices_offset = (header.vertices_offset + data.get_verts_size() + 15) & ~static_cast<std::uint64_t>(15);
+
+	std::vector<MeshFileAttribute> table;
+	for(const VertexAttribute &attribute : attributes) {
+		table.push_back({(std::uint32_t) attribute.size, (std::uint32_t) attribute.offset, attribute.normalized, attribute.position});
+	}
+
+	// Write beside the destination and rename, so a crash never leaves half a file
+	const std::string temp_path = std::string(destination) + ".tmp";
+	{
+		const char zeros[16] = {};
+		std::ofstream file(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(MeshFileAttribute));
+		file.write(zeros, header.vertices_offset - table_end);
+		file.write(reinterpret_cast<const char*>(data.get_vertices()), data.get_verts_size());
+		file.write(zeros, header.indices_offset - header.vertices_offset - data.get_verts_size());
+		file.write(reinterpret_cast<const char*>(data.get_indices()), data.get_indices_size());
+		if(!file) {
+			ERROR("Could not write mesh file " << temp_path);
+			return false;
+		}
+	}
+	std::rename(temp_path.c_str(), destination);
+
+	return true;
+}
+
+MeshFile::MeshFile(const char *source) : file(source) {
+	header = nullptr;
+	if(!file.is_open()) return;
+
+	// The mapping is page aligned, so the header can be read in place
+	const unsigned char *data = file.get_data();
+	const MeshFileHeader *candidate = reinterpret_cast<const MeshFileHeader*>(data);
+	if(file.get_size() < sizeof(MeshFileHeader) || std::memcmp(candidate->magic, MESH_FILE_MAGIC, sizeof(candidate->magic)) != 0) {
+		ERROR("File " << source << " is not a mesh file");
+		return;
+	}
+	if(candidate->version != MESH_FILE_VERSION) {
+		ERROR("Mesh file " << source << " is version " << candidate->version << ", expected " << MESH_FILE_VERSION);
+		return;
+	}
+
+	const std::uint64_t verts_size = (std::uint64_t) candidate->num_verts * candidate->stride * sizeof(GLfloat);
+	const std::uint64_t indices_size = (std::uint64_t) candidate->num_elements * sizeof(GLuint);
+	if(sizeof(MeshFileHeader) + candidate->num_attributes * sizeof(MeshFileAttribute) > file.get_size()
+		|| candidate->vertices_offset % sizeof(GLfloat) != 0 || candidate->vertices_offset + verts_size > file.get_size()
+		|| candidate->indices_offset % sizeof(GLuint) != 0 || candidate->indices_offset + indices_size > file.get_size()) {
+		ERROR("Mesh file " << source << " is truncated");
+		return;
+	}
+
+	const MeshFileAttribute *table = reinterpret_cast<const MeshFileAttribute*>(data + sizeof(MeshFileHeader));
+	for(std::uint32_t i = 0; i < candidate->num_attributes; ++i) {
+		attributes.push_back({(GLint) table[i].size, (GLint) table[i].offset, (GLboolean) table[i].normalized, table[i].position != 0});
+	}
+	header = candidate;
+}
+
+MeshFile::MeshFile(MeshFile &&other) : file(std::move(other.file)) {
+	header = other.header;
+	attributes = std::move(other.attributes);
+	other.header = nullptr;
+}
+
+MeshFile &MeshFile::operator=(MeshFile &&other) {
+	if(this != &other) {
+		file = std::move(other.file);
+		header = other.header;
+		attributes = std::move(other.attributes);
+		other.header = nullptr;
+	}
+	return *this;
+}
+
+void MeshFile::release() {
+	file.release();
+	header = nullptr;
+	attributes.clear();
+}
+
+bool MeshFile::is_valid() { return header != nullptr; }
+const GLfloat *MeshFile::get_vertices() { return reinterpret_cast<const GLfloat*>(file.get_data() + header->vertices_offset); }
+const GLuint *MeshFile::get_indices() { return reinterpret_cast<const GLuint*>(file.get_data() + header->indices_offset); }
+int MeshFile::get_num_verts() { return header->num_verts; }
+int MeshFile::get_num_elements() { return header->num_elements; }
+int MeshFile::get_stride() { return header->stride; }
+int MeshFile::get_verts_size() { return header->num_verts * header->stride * sizeof(GLfloat); }
+int MeshFile::get_indices_size() { return header->num_elements * sizeof(GLuint); }
+const std::vector<VertexAttribute> &MeshFile::get_attributes() { return attributes; }
+
+} // namespace boa
@@ -0,0 +1,82 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+#include "gl_data.h"
+#include "mapped_file.h"
+#include "vertex_format.h"
+
+namespace boa {
+
+// Baked mesh file, written by write_mesh_file and read by MeshFile. Layout,
+// in host byte order:
+//   MeshFileHeader
+//   MeshFileAttribute[num_attributes]
+//   vertices, num_verts * stride GLfloats, 16-byte aligned
+//   indices, num_elements GLuints, 16-byte aligned
+// The version changes whenever the layout does; older files are rejected.
+const char MESH_FILE_MAGIC[4] = {'B', 'O', 'A', 'M'};
+const std::uint32_t MESH_FILE_VERSION = 1;
+
+struct MeshFileHeader {
+	char magic[4];
+	std::uint32_t version;
+	std::uint32_t stride; // GLfloats per vertex
+	std::uint32_t num_attributes;
+	std::uint32_t num_verts;
+	std::uint32_t num_elements;
+	std::uint64_t vertices_offset; // From the start of the file
+	std::uint64_t indices_offset;
+};
+
+struct MeshFileAttribute {
+	std::uint32_t size;
+	std::uint32_t offset;
+	std::uint32_t normalized;
+	std::uint32_t position;
+};
+
+// Save data's triangulated vertex and index arrays along with their layout
+bool write_mesh_file(GLData &data, const std::vector<VertexAttribute> &attributes, const char *destination);
+template<typename... Attributes> bool write_mesh_file(TypedGLData<Attributes...> &data, const char *destination) {
+	return write_mesh_file(data, VertexFormat<Attributes...>::get_attributes(), destination);
+}
+
+// A mapped mesh file. The arrays point into the mapping, so they can be given
+// straight to a buffer upload (see Mesh's MeshFile constructor) and stay
+// valid until release() or destruction.
+class MeshFile {
+private:
+	MappedFile file;
+	const MeshFileHeader *header;
+	std::vector<VertexAttribute> attributes;
+public:
+	MeshFile(const char *source);
+	MeshFile(const MeshFile&) = delete;
+	MeshFile(MeshFile &&other);
+
+	MeshFile &operator=(const MeshFile&) = delete;
+	MeshFile &operator=(MeshFile &&other);
+
+	void release();
+
+	bool is_valid();
+	const GLfloat *get_vertices();
+	const GLuint *get_indices();
+	int get_num_verts();
+	int get_num_elements();
+	int get_stride(); // GLfloats per vertex
+	int get_verts_size();
+	int get_indices_size();
+	const std::vector<VertexAttribute> &get_attributes();
+};
+
+} // namespace boa
+
+#endif // MESH_FILE_H
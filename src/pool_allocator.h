@@ -0,0 +1,152 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace boa {
+
+// Fixed-size block pool. The block size is taken from the first allocation,
+// so a single pool can back a node-based container through allocator rebinding.
+// Storage for `capacity` blocks is reserved once; requests beyond that fall
+// back to the global heap.
+class NodePool {
+private:
+	struct FreeBlock {
+		FreeBlock *next;
+	};
+
+	std::vector<unsigned char> storage;
+	FreeBlock *free_list;
+	std::size_t block_size;
+	std::size_t capacity;
+	std::size_t used;
+
+public:
+	NodePool(const std::size_t capacity) : free_list(nullptr), block_size(0), capacity(capacity), used(0) {}
+	NodePool(const NodePool&) = delete;
+	NodePool &operator=(const NodePool&) = delete;
+
+	void *allocate(const std::size_t size) {
+		if(block_size == 0) {
+			const std::size_t align = alignof(std::max_align_t);
+			block_size = (std::max(size, sizeof(FreeBlock)) + align - 1) / align * align;
+			storage.resize(block_size * capacity);
+		}
+
+		if(size > block_size) return ::operator new(size);
+
+		if(free_list != nullptr) {
+			FreeBlock *block = free_list;
+			free_list = block->next;
+			return block;
+		}
+
+		if(used < capacity) return &storage[block_size * used++];
+
+		return ::operator new(size);
+	}
+
+	// Forget every block and make room for `capacity` of them. Only valid once
+	// everything allocated from the pool has been released.
+	void reset(const std::size_t capacity) {
+		free_list = nullptr;
+		used = 0;
+		this->capacity = capacity;
+		if(block_size != 0 && storage.size() < block_size * capacity) storage.resize(block_size * capacity);
+	}
+
+	void deallocate(void *block) {
+		unsigned char *bytes = static_cast<unsigned char*>(block);
+		if(!storage.empty() && bytes >= storage.data() && bytes < storage.data() + storage.size()) {
+			FreeBlock *free_block = static_cast<FreeBlock*>(block);
+			free_block->next = free_list;
+			free_list = free_block;
+		} else {
+			::operator delete(block);
+		}
+	}
+};
+
+// Standard allocator adapter over a NodePool. Only single-object allocations
+// are pooled; array allocations go straight to the heap.
+template<typename T> class PoolAllocator {
+public:
+	using value_type = T;
+
+	NodePool *pool;
+
+	PoolAllocator(NodePool &pool) : pool(&pool) {}
+	template<typename U> PoolAllocator(const PoolAllocator<U> &other) : pool(other.pool) {}
+
+	T *allocate(const std::size_t n) {
+		if(n == 1) return static_cast<T*>(pool->allocate(sizeof(T)));
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T *p, const std::size_t n) {
+		if(n == 1) pool->deallocate(p);
+		else ::operator delete(p);
+	}
+
+	template<typename U> bool operator==(const PoolAllocator<U> &other) const { return pool == other.pool; }
+	template<typename U> bool operator!=(const PoolAllocator<U> &other) const { return pool != other.pool; }
+};
+
+// Interface for the storage behind GLData's vertex and index arrays.
+class BufferAllocator {
+public:
+	virtual ~BufferAllocator() {}
+
+	virtual void *allocate(const std::size_t size) = 0;
+	virtual void deallocate(void *block, const std::size_t size) = 0;
+};
+
+// Recycles released buffers by power-of-two size class, so meshes that are
+// regenerated or recreated every frame stop touching the heap once every size
+// they need has been seen. Not thread-safe.
+class BufferPool : public BufferAllocator {
+private:
+	static const int NUM_CLASSES = 48;
+	static const std::size_t MIN_BLOCK = 64;
+
+	std::vector<void*> free_blocks[NUM_CLASSES];
+
+	static int size_class(const std::size_t size) {
+		int size_class = 0;
+		while((MIN_BLOCK << size_class) < size) ++size_class;
+		return size_class;
+	}
+
+public:
+	BufferPool() {}
+	BufferPool(const BufferPool&) = delete;
+	BufferPool &operator=(const BufferPool&) = delete;
+
+	~BufferPool() {
+		for(auto &blocks : free_blocks) {
+			for(void *block : blocks) ::operator delete(block);
+		}
+	}
+
+	void *allocate(const std::size_t size) override {
+		const int index = size_class(size);
+		if(!free_blocks[index].empty()) {
+			void *block = free_blocks[index].back();
+			free_blocks[index].pop_back();
+			return block;
+		}
+
+		return ::operator new(MIN_BLOCK << index);
+	}
+
+	void deallocate(void *block, const std::size_t size) override {
+		if(block != nullptr) free_blocks[size_class(size)].push_back(block);
+	}
+};
+
+} // namespace boa
+
+#endif // POOL_ALLOCATOR_H
@@ -0,0 +1,256 @@
+#include "predicates.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BOA_X86
+#endif
+
+namespace boa {
+
+namespace {
+
+// Relative error bound of the double-precision orientation estimate, from
+// Shewchuk's "Adaptive Precision Floating-Point Arithmetic"
+const double EPSILON = 1.1102230246251565e-16; // 2^-53
+const double ORIENT_ERROR_BOUND = (3.0 + 16.0 * EPSILON) * EPSILON;
+
+// Exact a + b as the unevaluated sum sum + err
+inline void two_sum(const double a, const double b, double &sum, double &err) {
+	sum = a + b;
+	const double b_virtual = sum - a;
+	const double a_virtual = sum - b_virtual;
+	err = (a - a_virtual) + (b - b_virtual);
+}
+
+// Exact orientation by expanding the determinant into six products. A
+// product of two floats is exact in double, and the products are summed
+// into a nonoverlapping expansion whose largest component carries the sign.
+double orient2d_exact(const GLfloat *a, const GLfloat *b, const GLfloat *c) {
+	const double terms[6] = {
+		(double) a[0] * b[1], -(double) a[0] * c[1],
+		-(double) a[1] * b[0], (double) a[1] * c[0],
+		(double) b[0] * c[1], -(double) b[1] * c[0]
+	};
+
+	double expansion[6];
+	int length = 0;
+	for(const double term : terms) {
+		double q = term;
+		int new_length = 0;
+		for(int i = 0; i < length; ++i) {
+			double sum, err;
+			two_sum(q, expansion[i], sum, err);
+			q = sum;
+			if(err != 0) expansion[new_length++] = err;
+		}
+		if(q != 0) expansion[new_length++] = q;
+		length = new_length;
+	}
+
+	return length == 0 ? 0 : expansion[length - 1];
+}
+
+} // namespace
+
+double orient2d(const GLfloat *a, const GLfloat *b, const GLfloat *c) {
+	const double det_left = ((double) a[0] - c[0]) * ((double) b[1] - c[1]);
+	const double det_right = ((double) a[1] - c[1]) * ((double) b[0] - c[0]);
+	const double det = det_left - det_right;
+
+	const double error_bound = ORIENT_ERROR_BOUND * (std::abs(det_left) + std::abs(det_right));
+	if(det > error_bound || -det > error_bound) return det;
+
+	return orient2d_exact(a, b, c);
+}
+
+bool in_cone(const GLfloat *prev, const GLfloat *apex, const GLfloat *next, const GLfloat *p) {
+	if(orient2d(prev, apex, next) >= 0) {
+		// Convex: p must be left of apex->next and right of apex->prev
+		return orient2d(apex, next, p) > 0 && orient2d(apex, prev, p) < 0;
+	}
+
+	// Reflex: p must not be inside the outside cone
+	return !(orient2d(apex, next, p) <= 0 && orient2d(apex, prev, p) >= 0);
+}
+
+namespace {
+
+inline signed char sign(const double value) {
+	return (value > 0) - (value < 0);
+}
+
+// Turns at vertices [first, last) of a ring, one at a time
+void orient2d_ring_scalar(const GLfloat *vertices, const int stride, const int num_verts, const int first, const int last, signed char *signs) {
+	for(int i = first; i < last; ++i) {
+		const int prev = i == 0 ? num_verts - 1 : i - 1;
+		const int next = i == num_verts - 1 ? 0 : i + 1;
+		signs[i] = sign(orient2d(&vertices[prev * stride], &vertices[i * stride], &vertices[next * stride]));
+	}
+}
+
+void orient2d_triangles_scalar(const GLfloat *vertices, const int stride, const GLuint *indices, const int first, const int last, signed char *signs) {
+	for(int t = first; t < last; ++t) {
+		signs[t] = sign(orient2d(&vertices[indices[t * 3] * stride], &vertices[indices[t * 3 + 1] * stride], &vertices[indices[t * 3 + 2] * stride]));
+	}
+}
+
+#ifdef BOA_X86
+// Four orientations at once from gathered coordinates. Lanes whose estimate is
+// within the error bound are redone exactly by the caller; their bits are set
+// in the returned mask.
+__attribute__((target("avx2"))) inline int orient2d_avx2(__m256d ax, __m256d ay, __m256d bx, __m256d by, __m256d cx, __m256d cy, signed char *signs) {
+	const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffll));
+	const __m256d det_left = _mm256_mul_pd(_mm256_sub_pd(ax, cx), _mm256_sub_pd(by, cy));
+	const __m256d det_right = _mm256_mul_pd(_mm256_sub_pd(ay, cy), _mm256_sub_pd(bx, cx));
+	const __m256d det = _mm256_sub_pd(det_left, det_right);
+	const __m256d error_bound = _mm256_mul_pd(_mm256_set1_pd(ORIENT_ERROR_BOUND),
+		_mm256_add_pd(_mm256_and_pd(det_left, abs_mask), _mm256_and_pd(det_right, abs_mask)));
+
+	const int positive = _mm256_movemask_pd(_mm256_cmp_pd(det, error_bound, _CMP_GT_OQ));
+	const int negative = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_sub_pd(_mm256_setzero_pd(), det), error_bound, _CMP_GT_OQ));
+	for(int lane = 0; lane < 4; ++lane) {
+		signs[lane] = (positive >> lane & 1) - (negative >> lane & 1);
+	}
+
+	return ~(positive | negative) & 0xf;
+}
+
+__attribute__((target("avx2"))) void orient2d_ring_avx2(const GLfloat *vertices, const int stride, const int num_verts, signed char *signs) {
+	if(num_verts < 3) { // The first vertex's neighbours would overlap the vector lanes, or not exist
+		orient2d_ring_scalar(vertices, stride, num_verts, 0, num_verts, signs);
+		return;
+	}
+
+	const __m128i lane_offsets = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(stride));
+
+	int i = 1;
+	for(; i + 4 < num_verts; i += 4) {
+		const __m128i prev = _mm_add_epi32(_mm_set1_epi32((i - 1) * stride), lane_offsets);
+		const __m128i current = _mm_add_epi32(prev, _mm_set1_epi32(stride));
+		const __m128i next = _mm_add_epi32(current, _mm_set1_epi32(stride));
+
+		const int uncertain = orient2d_avx2(
+			_mm256_cvtps_pd(_mm_i32gather_ps(vertices, prev, 4)), _mm256_cvtps_pd(_mm_i32gather_ps(vertices + 1, prev, 4)),
+			_mm256_cvtps_pd(_mm_i32gather_ps(vertices, current, 4)), _mm256_cvtps_pd(_mm_i32gather_ps(vertices + 1, current, 4)),
+			_mm256_cvtps_pd(_mm_i32gather_ps(vertices, next, 4)), _mm256_cvtps_pd(_mm_i32gather_ps(vertices + 1, next, 4)),
+			&signs[i]);
+		for(int lane = 0; lane < 4; ++lane) {
+			if(uncertain >> lane & 1) orient2d_ring_scalar(vertices, stride, num_verts, i + lane, i + lane + 1, signs);
+		}
+	}
+
+	orient2d_ring_scalar(vertices, stride, num_verts, 0, 1, signs);
+	orient2d_ring_scalar(vertices, stride, num_verts, i, num_verts, signs);
+}
+
+__attribute__((target("avx2"))) void orient2d_triangles_avx2(const GLfloat *vertices, const int stride, const GLuint *indices, const int num_triangles, signed char *signs) {
+	const __m128i triangle_offsets = _mm_setr_epi32(0, 3, 6, 9);
+	const __m128i stride_vector = _mm_set1_epi32(stride);
+
+	int t = 0;
+	for(; t + 4 <= num_triangles; t += 4) {
+		const int *triangle_indices = reinterpret_cast<const int*>(&indices[t * 3]);
+		const __m128i a = _mm_mullo_epi32(_mm_i32gather_epi32(triangle_indices, triangle_offsets, 4), stride_vector);
+		const __m128i b = _mm_mullo_epi32(_mm_i32gather_epi32(triangle_indices + 1, triangle_offsets, 4), stride_vector);
+		const __m128i c = _mm_mullo_epi32(_mm_i32gather_epi32(triangle_indices + 2, triangle_offsets, 4), stride_vector);
+
+		const int uncertain = orient2d_avx2(
+			_mm256_cvtps_pd(_mm_i32gather_ps(vertices, a, 4)), _mm256_cvtps_pd(_mm_i32gather_ps(vertices + 1, a, 4)),
+			_mm256_cvtps_pd(_mm_i32gather_ps(vertices, b, 4)), _mm256_cvtps_pd(_mm_i32gather_ps(vertices + 1, b, 4)),
+			_mm256_cvtps_pd(_mm_i32gather_ps(vertices, c, 4)), _mm256_cvtps_pd(_mm_i32gather_ps(vertices + 1, c, 4)),
+			&signs[t]);
+		for(int lane = 0; lane < 4; ++lane) {
+			if(uncertain >> lane & 1) orient2d_triangles_scalar(vertices, stride, indices, t + lane, t + lane + 1, signs);
+		}
+	}
+
+	orient2d_triangles_scalar(vertices, stride, indices, t, num_triangles, signs);
+}
+
+// SSE2 is part of x86-64, so this needs no runtime check there
+inline int orient2d_sse2(const double *ax, const double *ay, const double *bx, const double *by, const double *cx, const double *cy, signed char *signs) {
+	const __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffll));
+	const __m128d det_left = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(ax), _mm_loadu_pd(cx)), _mm_sub_pd(_mm_loadu_pd(by), _mm_loadu_pd(cy)));
+	const __m128d det_right = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(ay), _mm_loadu_pd(cy)), _mm_sub_pd(_mm_loadu_pd(bx), _mm_loadu_pd(cx)));
+	const __m128d det = _mm_sub_pd(det_left, det_right);
+	const __m128d error_bound = _mm_mul_pd(_mm_set1_pd(ORIENT_ERROR_BOUND),
+		_mm_add_pd(_mm_and_pd(det_left, abs_mask), _mm_and_pd(det_right, abs_mask)));
+
+	const int positive = _mm_movemask_pd(_mm_cmpgt_pd(det, error_bound));
+	const int negative = _mm_movemask_pd(_mm_cmpgt_pd(_mm_sub_pd(_mm_setzero_pd(), det), error_bound));
+	signs[0] = (positive & 1) - (negative & 1);
+	signs[1] = (positive >> 1 & 1) - (negative >> 1 & 1);
+
+	return ~(positive | negative) & 0x3;
+}
+
+void orient2d_ring_sse2(const GLfloat *vertices, const int stride, const int num_verts, signed char *signs) {
+	if(num_verts < 3) { // The first vertex's neighbours would overlap the vector lanes, or not exist
+		orient2d_ring_scalar(vertices, stride, num_verts, 0, num_verts, signs);
+		return;
+	}
+
+	int i = 1;
+	for(; i + 2 < num_verts; i += 2) {
+		double x[4], y[4];
+		for(int j = 0; j < 4; ++j) {
+			x[j] = vertices[(i - 1 + j) * stride];
+			y[j] = vertices[(i - 1 + j) * stride + 1];
+		}
+
+		const int uncertain = orient2d_sse2(&x[0], &y[0], &x[1], &y[1], &x[2], &y[2], &signs[i]);
+		for(int lane = 0; lane < 2; ++lane) {
+			if(uncertain >> lane & 1) orient2d_ring_scalar(vertices, stride, num_verts, i + lane, i + lane + 1, signs);
+		}
+	}
+
+	orient2d_ring_scalar(vertices, stride, num_verts, 0, 1, signs);
+	orient2d_ring_scalar(vertices, stride, num_verts, i, num_verts, signs);
+}
+
+void orient2d_triangles_sse2(const GLfloat *vertices, const int stride, const GLuint *indices, const int num_triangles, signed char *signs) {
+	int t = 0;
+	for(; t + 2 <= num_triangles; t += 2) {
+		double x[3][2], y[3][2];
+		for(int lane = 0; lane < 2; ++lane) {
+			for(int corner = 0; corner < 3; ++corner) {
+				x[corner][lane] = vertices[indices[(t + lane) * 3 + corner] * stride];
+				y[corner][lane] = vertices[indices[(t + lane) * 3 + corner] * stride + 1];
+			}
+		}
+
+		const int uncertain = orient2d_sse2(x[0], y[0], x[1], y[1], x[2], y[2], &signs[t]);
+		for(int lane = 0; lane < 2; ++lane) {
+			if(uncertain >> lane & 1) orient2d_triangles_scalar(vertices, stride, indices, t + lane, t + lane + 1, signs);
+		}
+	}
+
+	orient2d_triangles_scalar(vertices, stride, indices, t, num_triangles, signs);
+}
+
+const bool HAS_AVX2 = __builtin_cpu_supports("avx2");
+#endif
+
+} // namespace
+
+void orient2d_ring(const GLfloat *vertices, const int stride, const int num_verts, signed char *signs) {
+#ifdef BOA_X86
+	if(HAS_AVX2) orient2d_ring_avx2(vertices, stride, num_verts, signs);
+	else orient2d_ring_sse2(vertices, stride, num_verts, signs);
+#else
+	orient2d_ring_scalar(vertices, stride, num_verts, 0, num_verts, signs);
+#endif
+}
+
+void orient2d_triangles(const GLfloat *vertices, const int stride, const GLuint *indices, const int num_triangles, signed char *signs) {
+#ifdef BOA_X86
+	if(HAS_AVX2) orient2d_triangles_avx2(vertices, stride, indices, num_triangles, signs);
+	else orient2d_triangles_sse2(vertices, stride, indices, num_triangles, signs);
+#else
+	orient2d_triangles_scalar(vertices, stride, indices, 0, num_triangles, signs);
+#endif
+}
+
+} // namespace boa
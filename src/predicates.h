@@ -0,0 +1,36 @@
+#ifndef PREDICATES_H
+#define PREDICATES_H
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Geometric predicates on 2D points stored as the first two GLfloats of a vertex.
+// Signs are exact: a fast double-precision estimate is used when its error
+// bound allows, otherwise the determinant is summed exactly. Requires IEEE
+// double arithmetic without extended precision (SSE2 on x86).
+
+// Twice the signed area of triangle abc. Positive when a, b, c turn
+// counterclockwise, negative when clockwise and zero when collinear. Only the
+// sign is exact.
+double orient2d(const GLfloat *a, const GLfloat *b, const GLfloat *c);
+
+// Whether p lies strictly inside the angle swept counterclockwise from the ray
+// apex->next to the ray apex->prev. For a counterclockwise polygon this is
+// the interior angle at apex, whether convex or reflex.
+bool in_cone(const GLfloat *prev, const GLfloat *apex, const GLfloat *next, const GLfloat *p);
+
+// Batch kernels over vertex arrays with the given stride, vectorized with
+// AVX2 or SSE2 where available. Signs are -1, 0 or 1.
+
+// Sign of the turn at every vertex of a closed ring: orient2d(prev, vertex, next)
+void orient2d_ring(const GLfloat *vertices, const int stride, const int num_verts, signed char *signs);
+
+// Sign of every indexed triangle: orient2d(a, b, c)
+void orient2d_triangles(const GLfloat *vertices, const int stride, const GLuint *indices, const int num_triangles, signed char *signs);
+
+} // namespace boa
+
+#endif // PREDICATES_H
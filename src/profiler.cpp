@@ -0,0 +1,211 @@
+#include "profiler.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace boa {
+
+namespace {
+
+// Chrome trace timestamps are in microseconds
+std::string microseconds(const std::uint64_t nanoseconds) {
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.3f", nanoseconds / 1000.0);
+	return buffer;
+}
+
+std::string escape(const char *name) {
+	std::string escaped;
+	for(const char *c = name; *c != '\0'; ++c) {
+		if(*c == '"' || *c == '\\') escaped += '\\';
+		escaped += *c;
+	}
+	return escaped;
+}
+
+void write_zone(std::ofstream &file, const char *name, const std::uint64_t start, const std::uint64_t duration, const int tid) {
+	file << ",\n{\"name\":\"" << escape(name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+		<< ",\"ts\":" << microseconds(start) << ",\"dur\":" << microseconds(duration) << "}";
+}
+
+void write_thread_name(std::ofstream &file, const int tid, const std::string &name) {
+	file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid << ",\"args\":{\"name\":\"" << name << "\"}}";
+}
+
+} // namespace
+
+Profiler::Profiler() {
+	epoch = std::chrono::steady_clock::now();
+	current = FrameStats();
+	in_frame = false;
+	gpu_zone_active = false;
+	ignored_gpu_zones = 0;
+}
+
+std::uint64_t Profiler::now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+// The calling thread's events, registered the first time it records
+Profiler::ThreadEvents &Profiler::local_events() {
+	static thread_local ThreadEvents *events = nullptr;
+	if(events == nullptr) {
+		std::lock_guard<std::mutex> lock(threads_mutex);
+		threads.emplace_back(new ThreadEvents());
+		threads.back()->thread = std::this_thread::get_id();
+		events = threads.back().get();
+	}
+	return *events;
+}
+
+void Profiler::add_cpu_zone(const char *name, const std::uint64_t start, const std::uint64_t end) {
+	local_events().events.push_back({name, start, end - start});
+}
+
+void Profiler::begin_gpu_zone(const char *name) {
+	if(gpu_zone_active) {
+		DEBUG("GPU zone " << name << " is nested in another and was dropped");
+		++ignored_gpu_zones;
+		return;
+	}
+
+	GLuint query;
+	if(free_queries.empty()) {
+		glGenQueries(1, &query);
+	} else {
+		query = free_queries.back();
+		free_queries.pop_back();
+	}
+
+	pending_zones.push_back({name, now(), query, in_frame ? (int) frames.size() : -1});
+	glBeginQuery(GL_TIME_ELAPSED, query);
+	gpu_zone_active = true;
+}
+
+void Profiler::end_gpu_zone() {
+	if(ignored_gpu_zones > 0) {
+		--ignored_gpu_zones;
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	gpu_zone_active = false;
+}
+
+// Collect finished queries, oldest first, stopping at the first that is not
+// available unless told to wait for it
+void Profiler::resolve_queries(const bool wait) {
+	std::size_t resolved = 0;
+	for(; resolved < pending_zones.size(); ++resolved) {
+		const GPUZone &zone = pending_zones[resolved];
+		if(gpu_zone_active && resolved + 1 == pending_zones.size()) break; // Still recording
+
+		if(!wait) {
+			GLuint available = GL_FALSE;
+			glGetQueryObjectuiv(zone.query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if(available == GL_FALSE) break;
+		}
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(zone.query, GL_QUERY_RESULT, &elapsed);
+		gpu_events.push_back({zone.name, zone.start, elapsed});
+		if(zone.frame >= 0 && zone.frame < (int) frames.size()) frames[zone.frame].gpu_time += elapsed;
+		free_queries.push_back(zone.query);
+	}
+	pending_zones.erase(pending_zones.begin(), pending_zones.begin() + resolved);
+}
+
+void Profiler::begin_frame() {
+	resolve_queries(false);
+
+	current = FrameStats();
+	current.start = now();
+	in_frame = true;
+}
+
+void Profiler::end_frame() {
+	if(!in_frame) return;
+
+	current.duration = now() - current.start;
+	frames.push_back(current);
+	in_frame = false;
+}
+
+void Profiler::count_draw(const int num_triangles) {
+	++current.draw_calls;
+	current.triangles += num_triangles;
+}
+
+void Profiler::count_upload(const std::uint64_t num_bytes) {
+	current.upload_bytes += num_bytes;
+}
+
+bool Profiler::write_chrome_trace(const char *path) {
+	resolve_queries(true);
+
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if(!file) {
+		ERROR("Could not open trace file " << path);
+		return false;
+	}
+
+	// Every event after the first starts with a comma, so open with metadata
+	file << "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"boa\"}}";
+
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	int tid = 0;
+	for(const std::unique_ptr<ThreadEvents> &thread : threads) {
+		write_thread_name(file, tid, "Thread " + std::to_string(tid));
+		for(const Event &event : thread->events) write_zone(file, event.name, event.start, event.duration, tid);
+		++tid;
+	}
+
+	const int gpu_tid = tid++;
+	write_thread_name(file, gpu_tid, "GPU");
+	for(const Event &event : gpu_events) write_zone(file, event.name, event.start, event.duration, gpu_tid);
+
+	const int frame_tid = tid++;
+	write_thread_name(file, frame_tid, "Frames");
+	for(const FrameStats &frame : frames) {
+		write_zone(file, "Frame", frame.start, frame.duration, frame_tid);
+		file << ",\n{\"name\":\"Frame counters\",\"ph\":\"C\",\"pid\":0,\"ts\":" << microseconds(frame.start)
+			<< ",\"args\":{\"draw_calls\":" << frame.draw_calls << ",\"triangles\":" << frame.triangles
+			<< ",\"upload_bytes\":" << frame.upload_bytes << ",\"gpu_us\":" << microseconds(frame.gpu_time) << "}}";
+	}
+
+	file << "\n]}\n";
+	if(!file) {
+		ERROR("Could not write trace file " << path);
+		return false;
+	}
+
+	return true;
+}
+
+void Profiler::clear() {
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	for(std::unique_ptr<ThreadEvents> &thread : threads) thread->events.clear();
+	gpu_events.clear();
+	frames.clear();
+
+	// Zones still waiting on their queries now belong to no frame
+	for(GPUZone &zone : pending_zones) zone.frame = -1;
+}
+
+const std::vector<FrameStats> &Profiler::get_frames() { return frames; }
+
+void Profiler::release() {
+	if(gpu_zone_active) end_gpu_zone();
+	for(const GPUZone &zone : pending_zones) free_queries.push_back(zone.query);
+	pending_zones.clear();
+	if(!free_queries.empty()) glDeleteQueries(free_queries.size(), free_queries.data());
+	free_queries.clear();
+}
+
+Profiler &profiler() {
+	static Profiler instance;
+	return instance;
+}
+
+} // namespace boa
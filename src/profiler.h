@@ -0,0 +1,140 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Profiling macros. They compile to nothing unless BOA_PROFILE is defined
+// (make profile), so they can stay in the hottest loops. Names must be
+// string literals, or otherwise outlive the profiler.
+#ifdef BOA_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) boa::ProfileScope PROFILE_CONCAT(profile_scope_, __COUNTER__)(name);
+#define PROFILE_GPU_SCOPE(name) boa::GPUProfileScope PROFILE_CONCAT(gpu_profile_scope_, __COUNTER__)(name);
+#define PROFILE_DRAW(num_triangles) boa::profiler().count_draw(num_triangles);
+#define PROFILE_UPLOAD(num_bytes) boa::profiler().count_upload(num_bytes);
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_GPU_SCOPE(name)
+#define PROFILE_DRAW(num_triangles)
+#define PROFILE_UPLOAD(num_bytes)
+#endif
+
+// Totals for one frame, from begin_frame to end_frame
+struct FrameStats {
+	std::uint64_t start; // Nanoseconds since the profiler started
+	std::uint64_t duration;
+	std::uint64_t gpu_time; // Sum of the frame's GPU zones, once their queries resolve
+	int draw_calls;
+	int triangles;
+	std::uint64_t upload_bytes;
+};
+
+// Collects CPU zones from any thread, GPU zones timed with GL_TIME_ELAPSED
+// queries, and per-frame counters, and writes them as a Chrome trace
+// (chrome://tracing or ui.perfetto.dev).
+//
+// GPU queries are read back once the driver reports them available, usually
+// a frame or two late, so reading never stalls. Resolved queries go back into
+// a pool, so steady frames create none. GPU zones cannot nest, since only one
+// GL_TIME_ELAPSED query can be active, and they are placed on their own track
+// at the CPU time they were issued. GPU zones, frames and counters belong to
+// the GL thread. Export between frames, while no other thread is recording.
+class Profiler {
+private:
+	struct Event {
+		const char *name;
+		std::uint64_t start;
+		std::uint64_t duration;
+	};
+
+	struct ThreadEvents {
+		std::thread::id thread;
+		std::vector<Event> events;
+	};
+
+	struct GPUZone {
+		const char *name;
+		std::uint64_t start;
+		GLuint query;
+		int frame; // Index into frames, or -1 outside a frame
+	};
+
+	std::chrono::steady_clock::time_point epoch;
+
+	std::mutex threads_mutex;
+	std::vector<std::unique_ptr<ThreadEvents>> threads;
+
+	std::vector<FrameStats> frames;
+	FrameStats current;
+	bool in_frame;
+
+	std::vector<Event> gpu_events;
+	std::vector<GPUZone> pending_zones; // Oldest first, as queries complete in order
+	std::vector<GLuint> free_queries;
+	bool gpu_zone_active;
+	int ignored_gpu_zones; // Nested zones, which are dropped
+
+	ThreadEvents &local_events();
+	void resolve_queries(const bool wait);
+public:
+	Profiler();
+	Profiler(const Profiler&) = delete;
+
+	Profiler &operator=(const Profiler&) = delete;
+
+	std::uint64_t now(); // Nanoseconds since the profiler started
+
+	void add_cpu_zone(const char *name, const std::uint64_t start, const std::uint64_t end);
+	void begin_gpu_zone(const char *name);
+	void end_gpu_zone();
+
+	void begin_frame();
+	void end_frame();
+	void count_draw(const int num_triangles);
+	void count_upload(const std::uint64_t num_bytes);
+
+	// Write everything recorded so far as Chrome trace JSON. Waits for any
+	// unresolved GPU queries first.
+	bool write_chrome_trace(const char *path);
+	void clear();
+
+	const std::vector<FrameStats> &get_frames();
+	void release(); // Delete the GL queries, before the context goes away
+};
+
+// The process-wide profiler
+Profiler &profiler();
+
+// Records a CPU zone from construction to destruction
+class ProfileScope {
+private:
+	const char *name;
+	std::uint64_t start;
+public:
+	ProfileScope(const char *name) : name(name), start(profiler().now()) {}
+	~ProfileScope() { profiler().add_cpu_zone(name, start, profiler().now()); }
+};
+
+// Records a GPU zone around the GL commands issued during its lifetime
+class GPUProfileScope {
+public:
+	GPUProfileScope(const char *name) { profiler().begin_gpu_zone(name); }
+	~GPUProfileScope() { profiler().end_gpu_zone(); }
+};
+
+} // namespace boa
+
+#endif // PROFILER_H
@@ -0,0 +1,285 @@
+#include "program.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "boa_fns.h"
+#include "gl_state.h"
+
+namespace boa {
+
+Program::Program(std::initializer_list<GLuint> shaders) {
+	program = create_program(shaders);
+	prepare();
+}
+
+Program::Program(const char *vertex_source, const char *fragment_source) {
+	const GLuint vertex_shader = compile_shader(vertex_source, GL_VERTEX_SHADER);
+	const GLuint fragment_shader = compile_shader(fragment_source, GL_FRAGMENT_SHADER);
+	program = create_program({vertex_shader, fragment_shader});
+	prepare();
+	glDeleteShader(vertex_shader);
+	glDeleteShader(fragment_shader);
+}
+
+Program::Program(const GLuint program) {
+	this->program = program;
+	prepare();
+}
+
+Program::Program(Program &&other) {
+	program = 0;
+	*this = std::move(other);
+}
+
+Program &Program::operator=(Program &&other) {
+	if(this == &other) return *this;
+
+	if(program != 0) gl_state().delete_program(program);
+	program = other.program;
+	direct = other.direct;
+	uniforms = std::move(other.uniforms);
+	uniform_indices = std::move(other.uniform_indices);
+	other.program = 0;
+
+	return *this;
+}
+
+Program::~Program() {
+	release();
+}
+
+void Program::prepare() {
+	direct = GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects;
+	if(!is_linked()) return;
+
+	// Read the camera block, if any, from the shared binding point
+	const GLuint camera_index = glGetUniformBlockIndex(program, "Camera");
+	if(camera_index != GL_INVALID_INDEX) glUniformBlockBinding(program, camera_index, CAMERA_BINDING);
+
+	reflect();
+}
+
+// Record the location and type of every active uniform outside a block
+void Program::reflect() {
+	GLint num_uniforms = 0;
+	GLint max_name_length = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &num_uniforms);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+	std::vector<GLchar> name(max_name_length + 1);
+	for(GLint i = 0; i < num_uniforms; ++i) {
+		Uniform uniform;
+		GLsizei name_length = 0;
+		glGetActiveUniform(program, i, name.size(), &name_length, &uniform.size, &uniform.type, name.data());
+		uniform.location = glGetUniformLocation(program, name.data());
+		uniform.cached = false;
+		if(uniform.location < 0) continue; // Block members have no location
+
+		// Arrays are reported as name[0]; look them up by their plain name
+		std::string uniform_name(name.data(), name_length);
+		if(uniform_name.size() > 3 && uniform_name.compare(uniform_name.size() - 3, 3, "[0]") == 0) {
+			uniform_name.resize(uniform_name.size() - 3);
+		}
+
+		uniform_indices[uniform_name] = uniforms.size();
+		uniforms.push_back(uniform);
+		DEBUG("Uniform " << uniform_name << " at location " << uniform.location);
+	}
+}
+
+namespace {
+
+// Uniform types set with a single integer
+bool integer_uniform(const GLenum type) {
+	switch(type) {
+	case GL_INT: case GL_BOOL:
+	case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+	case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY:
+	case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_SAMPLER_CUBE_SHADOW: case GL_SAMPLER_BUFFER:
+	case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_RECT:
+	case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_3D:
+	case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_3D:
+		return true;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+Program::Uniform *Program::find(const int index, const GLenum type) {
+	if(index < 0) return nullptr; // Inactive uniforms are optimized out, so this is not an error
+	if(index >= (int) uniforms.size()) {
+		ERROR("No uniform at index " << index);
+		return nullptr;
+	}
+
+	Uniform &uniform = uniforms[index];
+	if(type == GL_INT ? !integer_uniform(uniform.type) : uniform.type != type) {
+		ERROR("Uniform at location " << uniform.location << " set with the wrong type");
+		return nullptr;
+	}
+
+	return &uniform;
+}
+
+// Update the cached value, returning whether it differed
+bool Program::changed(Uniform &uniform, const void *value, const std::size_t size) {
+	if(uniform.cached && std::memcmp(uniform.value, value, size) == 0) return false;
+
+	std::memcpy(uniform.value, value, size);
+	uniform.cached = true;
+	return true;
+}
+
+// Whether to upload with glProgramUniform*. Otherwise this program is made
+// current, so glUniform* reaches it and not whichever program was in use.
+bool Program::upload_directly() {
+	if(!direct) use();
+	return direct;
+}
+
+void Program::use() { gl_state().use_program(program); }
+
+void Program::release() {
+	if(program != 0) gl_state().delete_program(program);
+	program = 0;
+	uniforms.clear();
+	uniform_indices.clear();
+}
+
+bool Program::is_linked() {
+	if(program == 0) return false;
+
+	GLint success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	return success;
+}
+
+bool Program::has_uniform(const std::string &name) { return uniform_indices.count(name) != 0; }
+
+int Program::uniform_index(const std::string &name) {
+	const auto it = uniform_indices.find(name);
+	return it == uniform_indices.end() ? -1 : it->second;
+}
+
+Program &Program::set_uniform(const std::string &name, const GLint value) { return set_uniform(uniform_index(name), value); }
+Program &Program::set_uniform(const std::string &name, const GLfloat value) { return set_uniform(uniform_index(name), value); }
+Program &Program::set_uniform(const std::string &name, const glm::vec2 &value) { return set_uniform(uniform_index(name), value); }
+Program &Program::set_uniform(const std::string &name, const glm::vec3 &value) { return set_uniform(uniform_index(name), value); }
+Program &Program::set_uniform(const std::string &name, const glm::vec4 &value) { return set_uniform(uniform_index(name), value); }
+Program &Program::set_uniform(const std::string &name, const glm::mat4 &value) { return set_uniform(uniform_index(name), value); }
+
+Program &Program::set_uniform(const int index, const GLint value) {
+	Uniform *uniform = find(index, GL_INT); // Also bools and samplers
+	if(uniform == nullptr || !changed(*uniform, &value, sizeof(value))) return *this;
+
+	if(upload_directly()) glProgramUniform1i(program, uniform->location, value);
+	else glUniform1i(uniform->location, value);
+	return *this;
+}
+
+Program &Program::set_uniform(const int index, const GLfloat value) {
+	Uniform *uniform = find(index, GL_FLOAT);
+	if(uniform == nullptr || !changed(*uniform, &value, sizeof(value))) return *this;
+
+	if(upload_directly()) glProgramUniform1f(program, uniform->location, value);
+	else glUniform1f(uniform->location, value);
+	return *this;
+}
+
+Program &Program::set_uniform(const int index, const glm::vec2 &value) {
+	Uniform *uniform = find(index, GL_FLOAT_VEC2);
+	if(uniform == nullptr || !changed(*uniform, glm::value_ptr(value), sizeof(value))) return *this;
+
+	if(upload_directly()) glProgramUniform2fv(program, uniform->location, 1, glm::value_ptr(value));
+	else glUniform2fv(uniform->location, 1, glm::value_ptr(value));
+	return *this;
+}
+
+Program &Program::set_uniform(const int index, const glm::vec3 &value) {
+	Uniform *uniform = find(index, GL_FLOAT_VEC3);
+	if(uniform == nullptr || !changed(*uniform, glm::value_ptr(value), sizeof(value))) return *this;
+
+	if(upload_directly()) glProgramUniform3fv(program, uniform->location, 1, glm::value_ptr(value));
+	else glUniform3fv(uniform->location, 1, glm::value_ptr(value));
+	return *this;
+}
+
+Program &Program::set_uniform(const int index, const glm::vec4 &value) {
+	Uniform *uniform = find(index, GL_FLOAT_VEC4);
+	if(uniform == nullptr || !changed(*uniform, glm::value_ptr(value), sizeof(value))) return *this;
+
+	if(upload_directly()) glProgramUniform4fv(program, uniform->location, 1, glm::value_ptr(value));
+	else glUniform4fv(uniform->location, 1, glm::value_ptr(value));
+	return *this;
+}
+
+Program &Program::set_uniform(const int index, const glm::mat4 &value) {
+	Uniform *uniform = find(index, GL_FLOAT_MAT4);
+	if(uniform == nullptr || !changed(*uniform, glm::value_ptr(value), sizeof(value))) return *this;
+
+	if(upload_directly()) glProgramUniformMatrix4fv(program, uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+	else glUniformMatrix4fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+	return *this;
+}
+
+GLuint Program::get_program() { return program; }
+
+CameraBuffer::CameraBuffer() {
+	block.view = glm::mat4(1.0f);
+	block.projection = glm::mat4(1.0f);
+	view_dirty = false;
+	projection_dirty = false;
+
+	glGenBuffers(1, &ubo);
+	gl_state().bind_buffer(GL_UNIFORM_BUFFER, ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), &block, GL_DYNAMIC_DRAW);
+	gl_state().bind_buffer(GL_UNIFORM_BUFFER, 0);
+	gl_state().bind_buffer_base(GL_UNIFORM_BUFFER, CAMERA_BINDING, ubo);
+}
+
+CameraBuffer::~CameraBuffer() {
+	release();
+}
+
+void CameraBuffer::set_view(const glm::mat4 &view) {
+	if(view == block.view) return;
+	block.view = view;
+	view_dirty = true;
+}
+
+void CameraBuffer::set_projection(const glm::mat4 &projection) {
+	if(projection == block.projection) return;
+	block.projection = projection;
+	projection_dirty = true;
+}
+
+void CameraBuffer::update() {
+	if(!view_dirty && !projection_dirty) return;
+
+	gl_state().bind_buffer(GL_UNIFORM_BUFFER, ubo);
+	if(view_dirty && projection_dirty) {
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+	} else if(view_dirty) {
+		glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, view), sizeof(glm::mat4), glm::value_ptr(block.view));
+	} else {
+		glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, projection), sizeof(glm::mat4), glm::value_ptr(block.projection));
+	}
+	gl_state().bind_buffer(GL_UNIFORM_BUFFER, 0);
+
+	view_dirty = false;
+	projection_dirty = false;
+}
+
+void CameraBuffer::release() {
+	if(ubo != 0) gl_state().delete_buffers(1, &ubo);
+	ubo = 0;
+}
+
+GLuint CameraBuffer::get_ubo() { return ubo; }
+
+} // namespace boa
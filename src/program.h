@@ -0,0 +1,115 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Uniform block binding point shared by every program's Camera block:
+//     layout (std140) uniform Camera { mat4 view; mat4 projection; };
+const GLuint CAMERA_BINDING = 0;
+
+// Linked shader program with every active uniform looked up once at link time.
+// Setters remember the last value uploaded to each uniform and skip uploads
+// that would not change it. They always upload to this program: directly with
+// glProgramUniform* on GL 4.1 or ARB_separate_shader_objects, otherwise by
+// making it the program in use first.
+class Program {
+private:
+	struct Uniform {
+		GLint location;
+		GLenum type;
+		GLint size; // Array length
+		bool cached; // Whether value holds the last upload
+		unsigned char value[sizeof(glm::mat4)];
+	};
+
+	GLuint program;
+	bool direct; // glProgramUniform* is available
+	std::vector<Uniform> uniforms;
+	std::unordered_map<std::string, int> uniform_indices;
+
+	void prepare();
+	void reflect();
+	Uniform *find(const int index, const GLenum type);
+	bool changed(Uniform &uniform, const void *value, const std::size_t size);
+	bool upload_directly();
+public:
+	Program(std::initializer_list<GLuint> shaders);
+	Program(const char *vertex_source, const char *fragment_source); // Compiles the shaders from files
+	explicit Program(const GLuint program); // Takes ownership of an already linked program
+	Program(const Program&) = delete;
+	Program(Program &&other);
+	~Program();
+
+	Program &operator=(const Program&) = delete;
+	Program &operator=(Program &&other);
+
+	void use();
+	void release();
+	bool is_linked();
+	bool has_uniform(const std::string &name);
+	int uniform_index(const std::string &name); // -1 if inactive, which setters ignore
+
+	Program &set_uniform(const std::string &name, const GLint value);
+	Program &set_uniform(const std::string &name, const GLfloat value);
+	Program &set_uniform(const std::string &name, const glm::vec2 &value);
+	Program &set_uniform(const std::string &name, const glm::vec3 &value);
+	Program &set_uniform(const std::string &name, const glm::vec4 &value);
+	Program &set_uniform(const std::string &name, const glm::mat4 &value);
+
+	// By uniform_index, skipping the name lookup
+	Program &set_uniform(const int index, const GLint value);
+	Program &set_uniform(const int index, const GLfloat value);
+	Program &set_uniform(const int index, const glm::vec2 &value);
+	Program &set_uniform(const int index, const glm::vec3 &value);
+	Program &set_uniform(const int index, const glm::vec4 &value);
+	Program &set_uniform(const int index, const glm::mat4 &value);
+
+	GLuint get_program();
+};
+
+// View and projection matrices in one uniform buffer bound at CAMERA_BINDING,
+// read by every program with a Camera block. Moving the camera is a single
+// buffer update however many programs use it.
+class CameraBuffer {
+private:
+	struct Block {
+		glm::mat4 view;
+		glm::mat4 projection;
+	};
+
+	GLuint ubo;
+	Block block;
+	bool view_dirty;
+	bool projection_dirty;
+
+public:
+	CameraBuffer();
+	CameraBuffer(const CameraBuffer&) = delete;
+	~CameraBuffer();
+
+	CameraBuffer &operator=(const CameraBuffer&) = delete;
+
+	void set_view(const glm::mat4 &view);
+	void set_projection(const glm::mat4 &projection);
+
+	// Upload whichever matrices changed since the last call
+	void update();
+	void release();
+
+	GLuint get_ubo();
+};
+
+} // namespace boa
+
+#endif // PROGRAM_H
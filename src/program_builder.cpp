@@ -0,0 +1,147 @@
+#include "program_builder.h"
+
+#include "boa_fns.h"
+
+namespace boa {
+
+ProgramBuilder::ProgramBuilder() {
+	next_ticket = 0;
+	parallel = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+
+	// Let the driver use as many compiler threads as it likes
+	if(GLEW_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xffffffff);
+	else if(GLEW_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(0xffffffff);
+}
+
+ProgramBuilder::~ProgramBuilder() {
+	while(!builds.empty()) cancel(builds.begin()->first);
+}
+
+int ProgramBuilder::request(const char *vertex_path, const char *fragment_path) {
+	return request_source(read_file(vertex_path), read_file(fragment_path), std::string(vertex_path) + " + " + fragment_path);
+}
+
+// Submit both compiles and the link back to back. Nothing here asks for a
+// status, so the driver is free to work on them in the background.
+int ProgramBuilder::request_source(const std::string &vertex_source, const std::string &fragment_source, const std::string &name) {
+	Build build;
+	build.name = name;
+	build.done = false;
+	build.linked = false;
+
+	const char *vertex_c_str = vertex_source.c_str();
+	const char *fragment_c_str = fragment_source.c_str();
+	build.vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(build.vertex_shader, 1, &vertex_c_str, NULL);
+	glCompileShader(build.vertex_shader);
+	build.fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(build.fragment_shader, 1, &fragment_c_str, NULL);
+	glCompileShader(build.fragment_shader);
+
+	build.program = glCreateProgram();
+	glAttachShader(build.program, build.vertex_shader);
+	glAttachShader(build.program, build.fragment_shader);
+	glLinkProgram(build.program);
+
+	const int ticket = next_ticket++;
+	builds[ticket] = build;
+	return ticket;
+}
+
+// Read the link result, which waits if the driver is not done yet
+void ProgramBuilder::finish(Build &build) {
+	GLint success;
+	glGetProgramiv(build.program, GL_LINK_STATUS, &success);
+	build.linked = success;
+
+	if(!success) {
+		GLchar info_log[512];
+		for(const GLuint shader : {build.vertex_shader, build.fragment_shader}) {
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+			if(!success) {
+				glGetShaderInfoLog(shader, 512, NULL, info_log);
+				ERROR(build.name << ":" << info_log);
+			}
+		}
+		glGetProgramInfoLog(build.program, 512, NULL, info_log);
+		ERROR(build.name << " failed to link:" << info_log);
+
+		glDeleteProgram(build.program);
+		build.program = 0;
+	} else {
+		glDetachShader(build.program, build.vertex_shader);
+		glDetachShader(build.program, build.fragment_shader);
+	}
+
+	glDeleteShader(build.vertex_shader);
+	glDeleteShader(build.fragment_shader);
+	build.vertex_shader = 0;
+	build.fragment_shader = 0;
+	build.done = true;
+}
+
+int ProgramBuilder::poll() {
+	int num_finished = 0;
+	for(auto &entry : builds) {
+		Build &build = entry.second;
+		if(build.done) continue;
+
+		if(parallel) {
+			GLint complete;
+			glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &complete);
+			if(!complete) continue;
+		} else if(num_finished > 0) {
+			break; // Finishing blocks without the extension, so only one per poll
+		}
+
+		finish(build);
+		++num_finished;
+	}
+
+	return num_finished;
+}
+
+bool ProgramBuilder::is_ready(const int ticket) {
+	const auto it = builds.find(ticket);
+	return it != builds.end() && it->second.done;
+}
+
+bool ProgramBuilder::is_linked(const int ticket) {
+	const auto it = builds.find(ticket);
+	return it != builds.end() && it->second.linked;
+}
+
+Program ProgramBuilder::take(const int ticket) {
+	const auto it = builds.find(ticket);
+	if(it == builds.end() || !it->second.done) {
+		ERROR("Program build " << ticket << " is not ready");
+		return Program(0);
+	}
+
+	const GLuint program = it->second.program;
+	builds.erase(it);
+	return Program(program);
+}
+
+void ProgramBuilder::cancel(const int ticket) {
+	const auto it = builds.find(ticket);
+	if(it == builds.end()) return;
+
+	Build &build = it->second;
+	if(build.vertex_shader != 0) glDeleteShader(build.vertex_shader);
+	if(build.fragment_shader != 0) glDeleteShader(build.fragment_shader);
+	if(build.program != 0) glDeleteProgram(build.program);
+	builds.erase(it);
+}
+
+int ProgramBuilder::get_num_pending() {
+	int num_pending = 0;
+	for(const auto &entry : builds) {
+		if(!entry.second.done) ++num_pending;
+	}
+	return num_pending;
+}
+
+bool ProgramBuilder::is_parallel() { return parallel; }
+
+} // namespace boa
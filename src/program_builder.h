@@ -0,0 +1,66 @@
+#ifndef PROGRAM_BUILDER_H
+#define PROGRAM_BUILDER_H
+
+#include <string>
+#include <unordered_map>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+#include "program.h"
+
+namespace boa {
+
+// Compiles and links programs without waiting on the driver. request()
+// submits every shader and the link at once and returns immediately; poll()
+// collects the programs that are done. With KHR_parallel_shader_compile the
+// driver compiles on its own threads and poll() never blocks. Without it,
+// poll() finishes at most one program per call, so the wait is spread over
+// several frames.
+class ProgramBuilder {
+private:
+	struct Build {
+		GLuint program;
+		GLuint vertex_shader;
+		GLuint fragment_shader;
+		std::string name;
+		bool done;
+		bool linked;
+	};
+
+	std::unordered_map<int, Build> builds;
+	int next_ticket;
+	bool parallel;
+
+	void finish(Build &build);
+public:
+	ProgramBuilder();
+	ProgramBuilder(const ProgramBuilder&) = delete;
+	~ProgramBuilder();
+
+	ProgramBuilder &operator=(const ProgramBuilder&) = delete;
+
+	// Start building a program from shader files, returning a ticket for it
+	int request(const char *vertex_path, const char *fragment_path);
+	int request_source(const std::string &vertex_source, const std::string &fragment_source, const std::string &name);
+
+	// Finish whatever the driver has completed. Returns how many builds finished.
+	int poll();
+
+	bool is_ready(const int ticket); // Finished, whether or not it linked
+	bool is_linked(const int ticket);
+
+	// Hand over a finished program and forget the ticket. A program that failed
+	// to link is returned empty.
+	Program take(const int ticket);
+
+	// Abandon a build, finished or not
+	void cancel(const int ticket);
+
+	int get_num_pending();
+	bool is_parallel();
+};
+
+} // namespace boa
+
+#endif // PROGRAM_BUILDER_H
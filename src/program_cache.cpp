@@ -0,0 +1,171 @@
+#include "program_cache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include <sys/stat.h>
+
+#include "boa_fns.h"
+
+namespace boa {
+
+namespace {
+
+// Insert defines after the #version line, which must stay first
+std::string add_defines(const std::string &source, const std::string &defines) {
+	if(defines.empty()) return source;
+
+	std::size_t insert_at = 0;
+	if(source.compare(0, 8, "#version") == 0) {
+		insert_at = source.find('\n');
+		insert_at = insert_at == std::string::npos ? source.size() : insert_at + 1;
+	}
+
+	return source.substr(0, insert_at) + defines + source.substr(insert_at);
+}
+
+} // namespace
+
+ProgramCache::ProgramCache(const std::string &directory) {
+	this->directory = directory;
+	supported = GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary;
+	hits = 0;
+	misses = 0;
+
+	mkdir(directory.c_str(), 0755); // Fails harmlessly if it already exists
+}
+
+// FNV-1a over everything that decides what the driver would produce
+std::uint64_t ProgramCache::hash(const std::string &vertex_source, const std::string &fragment_source, const std::string &defines) {
+	std::uint64_t key = 14695981039346656037ull;
+	const auto mix = [&] (const char *bytes, const std::size_t size) {
+		for(std::size_t i = 0; i < size; ++i) {
+			key ^= (unsigned char) bytes[i];
+			key *= 1099511628211ull;
+		}
+		key ^= 0xff; // Separator, so moving text between parts changes the key
+		key *= 1099511628211ull;
+	};
+
+	mix(vertex_source.data(), vertex_source.size());
+	mix(fragment_source.data(), fragment_source.size());
+	mix(defines.data(), defines.size());
+	for(const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+		const char *value = (const char*) glGetString(name);
+		if(value != nullptr) mix(value, std::char_traits<char>::length(value));
+	}
+
+	return key;
+}
+
+std::string ProgramCache::path(const std::uint64_t key) {
+	char name[17];
+	std::snprintf(name, sizeof(name), "%016llx", (unsigned long long) key);
+	return directory + "/" + name + ".bin";
+}
+
+// Entries are the binary format followed by the binary itself
+GLuint ProgramCache::load_binary(const std::uint64_t key) {
+	std::ifstream file(path(key), std::ios::in | std::ios::binary);
+	if(!file.is_open()) return 0;
+
+	GLenum format;
+	if(!file.read(reinterpret_cast<char*>(&format), sizeof(format))) return 0;
+	const std::string binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if(binary.empty()) return 0;
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, format, binary.data(), binary.size());
+
+	GLint success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if(!success) {
+		DEBUG("Program binary " << path(key) << " was rejected");
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+void ProgramCache::store_binary(const std::uint64_t key, const GLuint program) {
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if(length <= 0) return;
+
+	std::vector<char> binary(length);
+	GLenum format;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+
+	// Write beside the entry and rename, so a crash never leaves half a binary
+	const std::string entry_path = path(key);
+	const std::string temp_path = entry_path + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+		file.write(binary.data(), length);
+		if(!file) {
+			ERROR("Could not write program binary " << temp_path);
+			return;
+		}
+	}
+	std::rename(temp_path.c_str(), entry_path.c_str());
+}
+
+GLuint ProgramCache::compile(const std::string &vertex_source, const std::string &fragment_source, const char *vertex_path, const char *fragment_path) {
+	const GLuint vertex_shader = compile_shader_source(vertex_source, GL_VERTEX_SHADER, vertex_path);
+	const GLuint fragment_shader = compile_shader_source(fragment_source, GL_FRAGMENT_SHADER, fragment_path);
+
+	GLuint program = glCreateProgram();
+	if(supported) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glAttachShader(program, vertex_shader);
+	glAttachShader(program, fragment_shader);
+	glLinkProgram(program);
+	glDetachShader(program, vertex_shader);
+	glDetachShader(program, fragment_shader);
+	glDeleteShader(vertex_shader);
+	glDeleteShader(fragment_shader);
+
+	GLint success;
+	GLchar info_log[512];
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if(!success) {
+		glGetProgramInfoLog(program, 512, NULL, info_log);
+		ERROR(vertex_path << " + " << fragment_path << " failed to link:" << info_log);
+	}
+
+	return program;
+}
+
+Program ProgramCache::load(const char *vertex_path, const char *fragment_path, const std::vector<std::string> &defines) {
+	std::string define_lines;
+	for(const std::string &define : defines) define_lines += "#define " + define + "\n";
+
+	const std::string vertex_source = add_defines(read_file(vertex_path), define_lines);
+	const std::string fragment_source = add_defines(read_file(fragment_path), define_lines);
+
+	const std::uint64_t key = hash(vertex_source, fragment_source, define_lines);
+	if(supported) {
+		const GLuint program = load_binary(key);
+		if(program != 0) {
+			++hits;
+			return Program(program);
+		}
+	}
+
+	++misses;
+	const GLuint program = compile(vertex_source, fragment_source, vertex_path, fragment_path);
+	if(supported) {
+		GLint success;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if(success) store_binary(key, program);
+	}
+
+	return Program(program);
+}
+
+int ProgramCache::get_hits() { return hits; }
+int ProgramCache::get_misses() { return misses; }
+
+} // namespace boa
@@ -0,0 +1,46 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+#include "program.h"
+
+namespace boa {
+
+// Stores linked program binaries on disk so later launches can skip shader
+// compilation. Entries are keyed by a hash of the shader sources, the defines
+// and the driver's vendor, renderer and version strings, so a driver update
+// never loads a stale binary. A binary the driver rejects is replaced by a
+// full compile. Needs GL 4.1 or ARB_get_program_binary; without it every
+// load compiles.
+class ProgramCache {
+private:
+	std::string directory;
+	bool supported;
+	int hits;
+	int misses;
+
+	std::uint64_t hash(const std::string &vertex_source, const std::string &fragment_source, const std::string &defines);
+	std::string path(const std::uint64_t key);
+	GLuint load_binary(const std::uint64_t key);
+	void store_binary(const std::uint64_t key, const GLuint program);
+	GLuint compile(const std::string &vertex_source, const std::string &fragment_source, const char *vertex_path, const char *fragment_path);
+public:
+	ProgramCache(const std::string &directory);
+
+	// Read both shaders, add "#define <define>" lines after their #version
+	// line, and return the linked program from the cache or a fresh compile
+	Program load(const char *vertex_path, const char *fragment_path, const std::vector<std::string> &defines = {});
+
+	int get_hits();
+	int get_misses();
+};
+
+} // namespace boa
+
+#endif // PROGRAM_CACHE_H
@@ -0,0 +1,134 @@
+#include "readback_ring.h"
+
+#include "gl_state.h"
+#include "profiler.h"
+
+namespace boa {
+
+namespace {
+
+const GLuint64 WAIT_TIMEOUT = 1000000; // Nanoseconds per glClientWaitSync when waiting
+
+} // namespace
+
+ReadbackRing::ReadbackRing(const int width, const int height, const int depth) {
+	this->width = width;
+	this->height = height;
+	oldest = 0;
+	num_queued = 0;
+	mapped = false;
+
+	// Written by the GPU and read by the CPU only, so drivers keep them in
+	// memory the CPU reads quickly
+	slots.resize(depth > 0 ? depth : 1);
+	for(Slot &slot : slots) {
+		glGenBuffers(1, &slot.buffer);
+		gl_state().bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		if(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) {
+			glBufferStorage(GL_PIXEL_PACK_BUFFER, get_frame_size(), nullptr, GL_MAP_READ_BIT | GL_CLIENT_STORAGE_BIT);
+		} else {
+			glBufferData(GL_PIXEL_PACK_BUFFER, get_frame_size(), nullptr, GL_STREAM_READ);
+		}
+		slot.fence = nullptr;
+		slot.id = 0;
+	}
+	gl_state().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+ReadbackRing::~ReadbackRing() {
+	release();
+}
+
+bool ReadbackRing::queue(const GLuint framebuffer, const std::uint64_t id) {
+	if(is_full()) {
+		ERROR("Readback ring is full; collect the oldest copy before queueing another");
+		return false;
+	}
+
+	Slot &slot = slots[(oldest + num_queued) % slots.size()];
+	slot.id = id;
+
+	// With a pack buffer bound, glReadPixels only schedules the copy
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glReadBuffer(framebuffer == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0);
+	gl_state().bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4); // RGBA8 rows are always 4-byte aligned
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	gl_state().bind_buffer(GL_PIXEL_PACK_BUFFER, 0); // Or later reads into client memory would land in it
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	++num_queued;
+	return true;
+}
+
+const unsigned char *ReadbackRing::map_oldest(std::uint64_t &id, const bool wait) {
+	PROFILE_SCOPE("ReadbackRing::map_oldest");
+	if(is_empty()) return nullptr;
+
+	Slot &slot = slots[oldest];
+	if(mapped) {
+		ERROR("The oldest readback is already mapped");
+		return nullptr;
+	}
+
+	if(slot.fence != nullptr) {
+		// The first check flushes, so the fence is sure to signal eventually
+		GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		while(wait && status == GL_TIMEOUT_EXPIRED) status = glClientWaitSync(slot.fence, 0, WAIT_TIMEOUT);
+
+		if(status == GL_TIMEOUT_EXPIRED) return nullptr;
+		if(status == GL_WAIT_FAILED) {
+			ERROR("Waiting on readback " << slot.id << " failed");
+			return nullptr;
+		}
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+	}
+
+	// The mapping outlives the binding
+	gl_state().bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, get_frame_size(), GL_MAP_READ_BIT);
+	gl_state().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+	if(pixels == nullptr) {
+		ERROR("Readback " << slot.id << " could not be mapped");
+		return nullptr;
+	}
+
+	mapped = true;
+	id = slot.id;
+	return static_cast<const unsigned char*>(pixels);
+}
+
+void ReadbackRing::unmap_oldest() {
+	if(is_empty()) return;
+
+	Slot &slot = slots[oldest];
+	if(mapped) {
+		gl_state().bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		gl_state().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+		mapped = false;
+	}
+	if(slot.fence != nullptr) { // Dropped without being mapped
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+	}
+
+	oldest = (oldest + 1) % slots.size();
+	--num_queued;
+}
+
+void ReadbackRing::release() {
+	while(!is_empty()) unmap_oldest();
+	for(Slot &slot : slots) gl_state().delete_buffers(1, &slot.buffer);
+	slots.clear();
+	oldest = 0;
+}
+
+bool ReadbackRing::is_full() { return num_queued == (int) slots.size(); }
+bool ReadbackRing::is_empty() { return num_queued == 0; }
+int ReadbackRing::get_num_queued() { return num_queued; }
+int ReadbackRing::get_depth() { return slots.size(); }
+std::size_t ReadbackRing::get_frame_size() { return (std::size_t) width * height * 4; }
+
+} // namespace boa
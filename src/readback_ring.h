@@ -0,0 +1,73 @@
+#ifndef READBACK_RING_H
+#define READBACK_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Asynchronous pixel readback through a ring of pixel pack buffers. queue()
+// starts copying a framebuffer into the next free buffer, fences the copy and
+// returns at once; the GPU finishes it while later frames are drawn. Collect
+// the oldest copy once the ring is full, so with the default depth of 3,
+// frame N is drawn while frame N-2 is read:
+//
+//     target.bind(); draw(); ring.queue(target.get_framebuffer(), n);
+//     if(ring.is_full()) {
+//         const unsigned char *pixels = ring.map_oldest(id, true);
+//         save(pixels, id);
+//         ring.unmap_oldest();
+//     }
+//
+// By the time a copy is collected its fence has normally signalled, so
+// mapping neither stalls the pipeline nor waits. Call map_oldest until
+// is_empty to drain the ring at the end. Pixels are tightly packed RGBA8,
+// bottom row first, as glReadPixels leaves them.
+class ReadbackRing {
+private:
+	struct Slot {
+		GLuint buffer;
+		GLsync fence; // Signalled once the copy into buffer is complete
+		std::uint64_t id;
+	};
+
+	std::vector<Slot> slots;
+	int width;
+	int height;
+	int oldest; // Slot of the oldest queued copy
+	int num_queued;
+	bool mapped; // The oldest slot's buffer is mapped
+public:
+	ReadbackRing(const int width, const int height, const int depth = 3);
+	ReadbackRing(const ReadbackRing&) = delete;
+	~ReadbackRing();
+
+	ReadbackRing &operator=(const ReadbackRing&) = delete;
+
+	// Copy framebuffer's first colour attachment into the next slot, tagged
+	// with id. Fails when the ring is full.
+	bool queue(const GLuint framebuffer, const std::uint64_t id);
+
+	// Pixels of the oldest queued copy, and its id. Without wait, returns
+	// nullptr if the copy has not finished yet. Valid until unmap_oldest.
+	const unsigned char *map_oldest(std::uint64_t &id, const bool wait);
+	void unmap_oldest(); // Frees the oldest slot for another copy
+
+	void release();
+
+	bool is_full();
+	bool is_empty();
+	int get_num_queued();
+	int get_depth();
+	std::size_t get_frame_size(); // Bytes per copy
+};
+
+} // namespace boa
+
+#endif // READBACK_RING_H
@@ -0,0 +1,66 @@
+#include "render_target.h"
+
+#include "gl_state.h"
+
+namespace boa {
+
+RenderTarget::RenderTarget(const int width, const int height) {
+	this->width = width;
+	this->height = height;
+
+	glGenTextures(1, &color);
+	gl_state().bind_texture(GL_TEXTURE_2D, color);
+	if(GLEW_VERSION_4_2 || GLEW_ARB_texture_storage) {
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+	} else {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	gl_state().bind_texture(GL_TEXTURE_2D, 0);
+
+	glGenRenderbuffers(1, &depth_stencil);
+	glBindRenderbuffer(GL_RENDERBUFFER, depth_stencil);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_stencil);
+	complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if(!complete) ERROR("Render target " << width << "x" << height << " is incomplete");
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+RenderTarget::~RenderTarget() {
+	release();
+}
+
+void RenderTarget::bind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, width, height);
+}
+
+void RenderTarget::unbind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderTarget::release() {
+	if(framebuffer != 0) glDeleteFramebuffers(1, &framebuffer);
+	if(depth_stencil != 0) glDeleteRenderbuffers(1, &depth_stencil);
+	if(color != 0) gl_state().delete_textures(1, &color);
+	framebuffer = 0;
+	depth_stencil = 0;
+	color = 0;
+	complete = false;
+}
+
+bool RenderTarget::is_complete() { return complete; }
+GLuint RenderTarget::get_framebuffer() { return framebuffer; }
+GLuint RenderTarget::get_texture() { return color; }
+int RenderTarget::get_width() { return width; }
+int RenderTarget::get_height() { return height; }
+
+} // namespace boa
@@ -0,0 +1,45 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <iostream>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Framebuffer object with an RGBA8 colour texture and a depth-stencil
+// renderbuffer, for drawing without a window or off the visible screen. Once
+// drawn, the colour texture can be sampled like any other, or copied back to
+// memory with a ReadbackRing.
+class RenderTarget {
+private:
+	GLuint framebuffer;
+	GLuint color;
+	GLuint depth_stencil;
+
+	int width;
+	int height;
+	bool complete;
+public:
+	RenderTarget(const int width, const int height);
+	RenderTarget(const RenderTarget&) = delete;
+	~RenderTarget();
+
+	RenderTarget &operator=(const RenderTarget&) = delete;
+
+	void bind(); // For drawing and reading, with a viewport covering it
+	static void unbind(); // Back to the default framebuffer
+	void release();
+
+	bool is_complete(); // Usable for drawing, as checked when created
+	GLuint get_framebuffer();
+	GLuint get_texture();
+	int get_width();
+	int get_height();
+};
+
+} // namespace boa
+
+#endif // RENDER_TARGET_H
@@ -0,0 +1,190 @@
+#include "stream_buffer.h"
+
+#include <cstring>
+
+#include "gl_state.h"
+#include "profiler.h"
+
+namespace boa {
+
+namespace {
+
+const std::size_t ALIGNMENT = 16;
+const GLuint64 WAIT_TIMEOUT = 1000000; // Nanoseconds per glClientWaitSync
+
+std::size_t align(const std::size_t size) {
+	return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+} // namespace
+
+StreamBuffer::StreamBuffer(const std::size_t region_size) {
+	this->region_size = align(region_size);
+	region = NUM_REGIONS - 1; // The first frame moves on to region 0
+	used = 0;
+	mapping = nullptr;
+	mapped_offset = 0;
+	num_enabled = 0;
+	for(GLsync &fence : fences) fence = nullptr;
+	persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &buffer);
+	gl_state().bind_vertex_array(vao);
+	gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, buffer); // Kept by the vertex array
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, buffer);
+
+	const GLsizeiptr size = this->region_size * NUM_REGIONS;
+	if(persistent) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+		mapping = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+		if(mapping == nullptr) ERROR("Stream buffer of " << size << " bytes could not be mapped");
+	} else {
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	}
+
+	gl_state().bind_vertex_array(0);
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+StreamBuffer::~StreamBuffer() {
+	release();
+}
+
+// Map the rest of the current region, on the orphaning path. The range is
+// either fresh storage or untouched since the last orphan, so nothing the GPU
+// reads is overwritten and the driver need not wait.
+bool StreamBuffer::map() {
+	if(used >= region_size) return false;
+
+	mapped_offset = region * region_size + used;
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, buffer);
+	mapping = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, mapped_offset, region_size - used,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	if(mapping == nullptr) {
+		ERROR("Stream buffer region " << region << " could not be mapped");
+		return false;
+	}
+	return true;
+}
+
+void StreamBuffer::begin_frame() {
+	PROFILE_SCOPE("StreamBuffer::begin_frame");
+	flush(); // In case the last frame was not ended
+
+	region = (region + 1) % NUM_REGIONS;
+	used = 0;
+
+	if(persistent) {
+		GLsync &fence = fences[region];
+		if(fence != nullptr) {
+			GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT);
+			while(status == GL_TIMEOUT_EXPIRED) status = glClientWaitSync(fence, 0, WAIT_TIMEOUT);
+			if(status == GL_WAIT_FAILED) ERROR("Waiting on stream buffer region " << region << " failed");
+
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	} else if(region == 0) {
+		// Orphan the storage: the driver hands over a fresh allocation and
+		// frees the old one once the GPU has finished with it
+		gl_state().bind_buffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, region_size * NUM_REGIONS, nullptr, GL_STREAM_DRAW);
+	}
+}
+
+void *StreamBuffer::allocate(const std::size_t size, GLintptr &offset) {
+	const std::size_t start = align(used);
+	if(start + size > region_size) {
+		ERROR("Stream buffer region of " << region_size << " bytes cannot fit " << size << " more");
+		return nullptr;
+	}
+
+	used = start;
+	if(mapping == nullptr && !map()) return nullptr;
+
+	offset = region * region_size + used;
+	used += size;
+	return mapping + (offset - mapped_offset);
+}
+
+bool StreamBuffer::write(GLData &data, StreamRange &range) {
+	GLintptr vertices_offset, indices_offset;
+	void *vertices = allocate(data.get_verts_size(), vertices_offset);
+	if(vertices == nullptr) return false;
+	void *indices = allocate(data.get_indices_size(), indices_offset);
+	if(indices == nullptr) return false;
+
+	std::memcpy(vertices, data.get_vertices(), data.get_verts_size());
+	std::memcpy(indices, data.get_indices(), data.get_indices_size());
+	PROFILE_UPLOAD(data.get_verts_size() + data.get_indices_size());
+
+	range.vertices_offset = vertices_offset;
+	range.indices_offset = indices_offset;
+	range.num_elements = data.get_num_elements();
+	range.stride = data.get_stride();
+	return true;
+}
+
+void StreamBuffer::flush() {
+	if(persistent || mapping == nullptr) return; // Coherent mappings need no flushing
+
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, buffer);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	mapping = nullptr;
+}
+
+// Vertices may start anywhere, so the attribute pointers are set per draw
+// rather than with a base vertex
+void StreamBuffer::draw(const StreamRange &range, const std::vector<VertexAttribute> &attributes) {
+	flush();
+	gl_state().bind_vertex_array(vao);
+	gl_state().bind_buffer(GL_ARRAY_BUFFER, buffer);
+
+	const int num_attributes = attributes.size();
+	for(int i = 0; i < num_attributes; ++i) {
+		glVertexAttribPointer(i, attributes[i].size, GL_FLOAT, attributes[i].normalized, range.stride * sizeof(GLfloat),
+			(GLvoid*) (range.vertices_offset + attributes[i].offset * sizeof(GLfloat)));
+		if(i >= num_enabled) glEnableVertexAttribArray(i);
+	}
+	for(int i = num_attributes; i < num_enabled; ++i) glDisableVertexAttribArray(i);
+	num_enabled = num_attributes;
+
+	glDrawElements(GL_TRIANGLES, range.num_elements, GL_UNSIGNED_INT, (GLvoid*) range.indices_offset);
+	PROFILE_DRAW(range.num_elements / 3);
+}
+
+void StreamBuffer::end_frame() {
+	flush();
+	if(!persistent) return;
+
+	if(fences[region] != nullptr) glDeleteSync(fences[region]);
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamBuffer::release() {
+	if(buffer == 0) return;
+
+	if(mapping != nullptr) {
+		gl_state().bind_buffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		mapping = nullptr;
+	}
+	for(GLsync &fence : fences) {
+		if(fence != nullptr) glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	gl_state().delete_vertex_arrays(1, &vao);
+	gl_state().delete_buffers(1, &buffer);
+	vao = 0;
+	buffer = 0;
+}
+
+bool StreamBuffer::is_persistent() { return persistent; }
+GLuint StreamBuffer::get_buffer() { return buffer; }
+std::size_t StreamBuffer::get_region_size() { return region_size; }
+std::size_t StreamBuffer::get_num_used() { return used; }
+
+} // namespace boa
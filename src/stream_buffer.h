@@ -0,0 +1,104 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+#include "gl_data.h"
+#include "vertex_format.h"
+
+namespace boa {
+
+// Where a GLData's arrays were written in a StreamBuffer. Valid until the
+// end of the frame they were written in.
+struct StreamRange {
+	GLintptr vertices_offset; // Bytes from the start of the buffer
+	GLintptr indices_offset;
+	int num_elements;
+	int stride; // GLfloats per vertex
+};
+
+// One large buffer for geometry that changes every frame, holding vertices
+// and indices alike. It is split into three regions used in turn, so the CPU
+// fills one while the GPU may still be drawing from the other two:
+//
+//     stream.begin_frame();
+//     stream.write(data, range); // Once per GLData
+//     stream.draw(range, attributes);
+//     stream.end_frame();
+//
+// With buffer storage (GL 4.4) the buffer is mapped once, persistently and
+// coherently, and a fence set at the end of each frame guards its region
+// until the region comes round again. That wait only happens if the GPU
+// falls three frames behind. On GL 3.3 the buffer is orphaned each time the
+// first region comes round, and regions are mapped unsynchronized, so the
+// driver never waits on its own either.
+//
+// GLData triangulates from its own positions, which must not be read back
+// from write-only mapped memory, so it is built in ordinary memory (a
+// BufferPool keeps that allocation-free) and each array is copied into the
+// mapping once. Nothing is staged or copied by the driver.
+class StreamBuffer {
+private:
+	static const int NUM_REGIONS = 3;
+
+	GLuint buffer;
+	GLuint vao;
+	GLsync fences[NUM_REGIONS]; // Set at the end of the frame that wrote each region
+
+	std::size_t region_size; // Bytes
+	int region; // Being written this frame
+	std::size_t used; // Bytes written to the current region
+
+	bool persistent;
+	unsigned char *mapping; // Bytes from mapped_offset onwards, or nullptr when unmapped
+	GLintptr mapped_offset;
+	int num_enabled; // Attribute arrays enabled in vao
+
+	bool map();
+public:
+	StreamBuffer(const std::size_t region_size);
+	StreamBuffer(const StreamBuffer&) = delete;
+	~StreamBuffer();
+
+	StreamBuffer &operator=(const StreamBuffer&) = delete;
+
+	// Move to the next region, waiting if the GPU may still be reading it
+	void begin_frame();
+
+	// Room for size bytes in this frame's region, 16-byte aligned, and its
+	// offset in the buffer. Returns nullptr when the region is full.
+	void *allocate(const std::size_t size, GLintptr &offset);
+
+	// Copy data's vertices and indices into this frame's region
+	bool write(GLData &data, StreamRange &range);
+
+	// Make everything written so far visible to GL. Only the orphaning path
+	// has anything to do; draw calls it for you.
+	void flush();
+
+	// Draw a range with attribute pointers starting at its vertices
+	void draw(const StreamRange &range, const std::vector<VertexAttribute> &attributes);
+	template<typename... Attributes> void draw(const StreamRange &range) {
+		static const std::vector<VertexAttribute> attributes = VertexFormat<Attributes...>::get_attributes();
+		draw(range, attributes);
+	}
+
+	// Fence this frame's region after every draw that reads it
+	void end_frame();
+
+	void release();
+
+	bool is_persistent();
+	GLuint get_buffer();
+	std::size_t get_region_size();
+	std::size_t get_num_used(); // Bytes written this frame
+};
+
+} // namespace boa
+
+#endif // STREAM_BUFFER_H
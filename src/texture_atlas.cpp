@@ -0,0 +1,258 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <stb_image.h>
+
+#include "boa_fns.h"
+#include "gl_state.h"
+
+namespace boa {
+
+SkylinePacker::SkylinePacker(const int width, const int height) : width(width), height(height) {
+	clear();
+}
+
+// Height the rectangle's bottom would rest at if its left edge started at
+// the given segment, or -1 if it does not fit there
+int SkylinePacker::fit(const std::size_t segment, const int rect_width, const int rect_height) const {
+	const int x = skyline[segment].x;
+	if(x + rect_width > width) return -1;
+
+	int y = 0;
+	int remaining = rect_width;
+	for(std::size_t i = segment; remaining > 0; ++i) {
+		y = std::max(y, skyline[i].y);
+		if(y + rect_height > height) return -1;
+		remaining -= skyline[i].width;
+	}
+
+	return y;
+}
+
+bool SkylinePacker::pack(const int rect_width, const int rect_height, int &x, int &y) {
+	int best_segment = -1;
+	int best_top = std::numeric_limits<int>::max();
+	for(std::size_t i = 0; i < skyline.size(); ++i) {
+		const int bottom = fit(i, rect_width, rect_height);
+		if(bottom >= 0 && bottom + rect_height < best_top) {
+			best_segment = i;
+			best_top = bottom + rect_height;
+		}
+	}
+	if(best_segment < 0) return false;
+
+	x = skyline[best_segment].x;
+	y = best_top - rect_height;
+
+	// Raise the skyline under the rectangle, trimming the segments it covers
+	skyline.insert(skyline.begin() + best_segment, {x, best_top, rect_width});
+	for(std::size_t i = best_segment + 1; i < skyline.size(); ) {
+		const int covered_to = x + rect_width;
+		if(skyline[i].x >= covered_to) break;
+
+		const int overlap = covered_to - skyline[i].x;
+		if(overlap >= skyline[i].width) {
+			skyline.erase(skyline.begin() + i);
+		} else {
+			skyline[i].x += overlap;
+			skyline[i].width -= overlap;
+			break;
+		}
+	}
+
+	// Merge neighbours at the same height
+	for(std::size_t i = 0; i + 1 < skyline.size(); ) {
+		if(skyline[i].y == skyline[i + 1].y) {
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		} else {
+			++i;
+		}
+	}
+
+	return true;
+}
+
+void SkylinePacker::clear() {
+	skyline.assign(1, {0, 0, width});
+}
+
+TextureAtlas::TextureAtlas(const int page_size, const int padding, const bool texture_array, const bool mipmaps) {
+	this->page_size = page_size;
+	this->padding = std::max(padding, 0);
+	this->texture_array = texture_array;
+	this->mipmaps = mipmaps;
+	num_pages = 0;
+
+	// Largest power of two within the padding, so every mip level up to its
+	// log2 sees whole gutters
+	alignment = 1;
+	while(alignment * 2 <= this->padding) alignment *= 2;
+}
+
+TextureAtlas::~TextureAtlas() {
+	release();
+}
+
+int TextureAtlas::add(const char *source) {
+	int width, height, channels;
+	unsigned char *pixels = stbi_load(source, &width, &height, &channels, 4);
+	if(pixels == nullptr) {
+		ERROR("Image " << source << " could not be loaded");
+		return -1;
+	}
+
+	const int image = add(pixels, width, height);
+	stbi_image_free(pixels);
+	return image;
+}
+
+int TextureAtlas::add(const unsigned char *rgba, const int width, const int height) {
+	images.push_back({std::vector<unsigned char>(rgba, rgba + width * height * 4), width, height});
+	return images.size() - 1;
+}
+
+// Copy an image into a page with its top left at (x, y), extending its edge
+// pixels outwards through the gutter
+void TextureAtlas::blit(std::vector<unsigned char> &page, const Image &image, const int x, const int y) {
+	const int rect_width = (image.width + 2 * padding + alignment - 1) / alignment * alignment;
+	const int rect_height = (image.height + 2 * padding + alignment - 1) / alignment * alignment;
+
+	for(int row = 0; row < rect_height; ++row) {
+		const int source_row = std::min(std::max(row - padding, 0), image.height - 1);
+		unsigned char *destination = &page[((y + row) * page_size + x) * 4];
+		const unsigned char *source = &image.pixels[source_row * image.width * 4];
+
+		for(int column = 0; column < padding; ++column) std::memcpy(destination + column * 4, source, 4);
+		std::memcpy(destination + padding * 4, source, image.width * 4);
+		for(int column = padding + image.width; column < rect_width; ++column) {
+			std::memcpy(destination + column * 4, source + (image.width - 1) * 4, 4);
+		}
+	}
+}
+
+bool TextureAtlas::build() {
+	release();
+	regions.assign(images.size(), AtlasRegion());
+
+	// Tallest first packs a skyline tightly
+	std::vector<int> order(images.size());
+	for(std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+	std::sort(order.begin(), order.end(), [&] (const int lhs, const int rhs) {
+		return images[lhs].height > images[rhs].height;
+	});
+
+	std::vector<std::vector<unsigned char>> pages;
+	std::vector<SkylinePacker> packers;
+	bool packed_all = true;
+	for(const int i : order) {
+		const Image &image = images[i];
+		const int rect_width = (image.width + 2 * padding + alignment - 1) / alignment * alignment;
+		const int rect_height = (image.height + 2 * padding + alignment - 1) / alignment * alignment;
+		if(rect_width > page_size || rect_height > page_size) {
+			ERROR("Image " << i << " (" << image.width << "x" << image.height << ") does not fit in a " << page_size << " atlas page");
+			packed_all = false;
+			continue;
+		}
+
+		// Try every open page before starting a new one
+		int page = 0, x = 0, y = 0;
+		const int num_pages = packers.size();
+		while(page < num_pages && !packers[page].pack(rect_width, rect_height, x, y)) ++page;
+		if(page == num_pages) {
+			packers.emplace_back(page_size, page_size);
+			pages.emplace_back(page_size * page_size * 4, 0);
+			packers.back().pack(rect_width, rect_height, x, y);
+		}
+
+		blit(pages[page], image, x, y);
+		regions[i].page = page;
+		regions[i].uv_rect = glm::vec4(
+			(float) (x + padding) / page_size, (float) (y + padding) / page_size,
+			(float) (x + padding + image.width) / page_size, (float) (y + padding + image.height) / page_size);
+	}
+
+	num_pages = pages.size();
+	DEBUG("Packed " << images.size() << " images into " << num_pages << " atlas pages");
+	upload(pages);
+
+	return packed_all;
+}
+
+void TextureAtlas::upload(const std::vector<std::vector<unsigned char>> &pages) {
+	if(pages.empty()) return;
+
+	const GLenum target = get_target();
+	textures.resize(texture_array ? 1 : pages.size());
+	glGenTextures(textures.size(), textures.data());
+
+	for(std::size_t page = 0; page < pages.size(); ++page) {
+		if(texture_array) {
+			gl_state().bind_texture(target, textures[0]);
+			if(page == 0) glTexImage3D(target, 0, GL_RGBA8, page_size, page_size, pages.size(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glTexSubImage3D(target, 0, 0, 0, page, page_size, page_size, 1, GL_RGBA, GL_UNSIGNED_BYTE, pages[page].data());
+		} else {
+			gl_state().bind_texture(target, textures[page]);
+			glTexImage2D(target, 0, GL_RGBA8, page_size, page_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, pages[page].data());
+		}
+
+		if(!texture_array || page + 1 == pages.size()) {
+			glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, get_max_level());
+			glTexParameteri(target, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+			glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			if(mipmaps) glGenerateMipmap(target);
+		}
+	}
+
+	gl_state().bind_texture(target, 0);
+}
+
+void TextureAtlas::bind(const GLenum unit, const int page) {
+	set_texture(get_target(), unit, textures[texture_array ? 0 : page]);
+}
+
+void TextureAtlas::release() {
+	if(!textures.empty()) gl_state().delete_textures(textures.size(), textures.data());
+	textures.clear();
+	num_pages = 0;
+}
+
+glm::vec2 TextureAtlas::map_uv(const int image, const glm::vec2 &uv) {
+	const glm::vec4 &rect = regions[image].uv_rect;
+	return glm::vec2(rect.x + uv.x * (rect.z - rect.x), rect.y + uv.y * (rect.w - rect.y));
+}
+
+std::vector<glm::vec2> TextureAtlas::map_uvs(const int image, const std::vector<glm::vec2> &uvs) {
+	std::vector<glm::vec2> mapped(uvs.size());
+	for(std::size_t i = 0; i < uvs.size(); ++i) mapped[i] = map_uv(image, uvs[i]);
+	return mapped;
+}
+
+std::vector<glm::vec3> TextureAtlas::map_layered_uvs(const int image, const std::vector<glm::vec2> &uvs) {
+	std::vector<glm::vec3> mapped(uvs.size());
+	for(std::size_t i = 0; i < uvs.size(); ++i) {
+		const glm::vec2 uv = map_uv(image, uvs[i]);
+		mapped[i] = glm::vec3(uv.x, uv.y, regions[image].page);
+	}
+	return mapped;
+}
+
+const AtlasRegion &TextureAtlas::get_region(const int image) { return regions[image]; }
+GLuint TextureAtlas::get_texture(const int page) { return textures[texture_array ? 0 : page]; }
+GLenum TextureAtlas::get_target() { return texture_array ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D; }
+int TextureAtlas::get_num_pages() { return num_pages; }
+
+int TextureAtlas::get_max_level() {
+	if(!mipmaps) return 0;
+
+	int level = 0;
+	while((1 << (level + 1)) <= alignment) ++level;
+	return level;
+}
+
+} // namespace boa
@@ -0,0 +1,102 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <iostream>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Packs rectangles into a fixed-size page with the skyline bottom-left rule:
+// each rectangle goes where its top edge ends lowest, leftmost on ties.
+class SkylinePacker {
+private:
+	struct Segment {
+		int x;
+		int y; // Height of the skyline over [x, x + width)
+		int width;
+	};
+
+	std::vector<Segment> skyline;
+	int width;
+	int height;
+
+	int fit(const std::size_t segment, const int rect_width, const int rect_height) const;
+public:
+	SkylinePacker(const int width, const int height);
+
+	bool pack(const int rect_width, const int rect_height, int &x, int &y);
+	void clear();
+};
+
+// Where an image ended up: the page (texture, or layer of the array texture)
+// and its texture coordinates as min u, min v, max u, max v.
+struct AtlasRegion {
+	int page;
+	glm::vec4 uv_rect;
+};
+
+// Packs many images into a few large RGBA textures, or layers of one
+// GL_TEXTURE_2D_ARRAY, so everything drawn from the atlas shares one bind.
+// Each image is surrounded by `padding` pixels copied from its edges, and
+// placed on a power-of-two grid, so filtering never picks up a neighbour.
+// With mipmaps, levels are capped where a level's texels would straddle two
+// images: padding of 2^k keeps levels 0 to k clean.
+class TextureAtlas {
+private:
+	struct Image {
+		std::vector<unsigned char> pixels; // RGBA
+		int width;
+		int height;
+	};
+
+	std::vector<Image> images;
+	std::vector<AtlasRegion> regions;
+	std::vector<GLuint> textures; // One per page, or a single array texture
+	int page_size;
+	int padding;
+	int alignment;
+	int num_pages;
+	bool texture_array;
+	bool mipmaps;
+
+	void blit(std::vector<unsigned char> &page, const Image &image, const int x, const int y);
+	void upload(const std::vector<std::vector<unsigned char>> &pages);
+public:
+	TextureAtlas(const int page_size = 2048, const int padding = 4, const bool texture_array = false, const bool mipmaps = true);
+	TextureAtlas(const TextureAtlas&) = delete;
+	~TextureAtlas();
+
+	TextureAtlas &operator=(const TextureAtlas&) = delete;
+
+	// Queue an image for the next build(), returning its index
+	int add(const char *source);
+	int add(const unsigned char *rgba, const int width, const int height);
+
+	// Pack every image and upload the pages, replacing any earlier build
+	bool build();
+
+	// Bind the atlas page, or the array texture, to a texture unit
+	void bind(const GLenum unit, const int page = 0);
+	void release();
+
+	// Map texture coordinates over a whole image into the atlas. The result
+	// can be written straight into GLData with set_attribute.
+	glm::vec2 map_uv(const int image, const glm::vec2 &uv);
+	std::vector<glm::vec2> map_uvs(const int image, const std::vector<glm::vec2> &uvs);
+	std::vector<glm::vec3> map_layered_uvs(const int image, const std::vector<glm::vec2> &uvs); // With the array layer as the third coordinate
+
+	const AtlasRegion &get_region(const int image);
+	GLuint get_texture(const int page = 0);
+	GLenum get_target();
+	int get_num_pages();
+	int get_max_level(); // Highest mip level free of bleeding
+};
+
+} // namespace boa
+
+#endif // TEXTURE_ATLAS_H
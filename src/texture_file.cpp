@@ -0,0 +1,358 @@
+#include "texture_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <stb_image.h>
+
+#include "boa_fns.h"
+#include "gl_state.h"
+#include "mapped_file.h"
+
+namespace boa {
+
+namespace {
+
+struct Level {
+	std::vector<unsigned char> pixels;
+	int width;
+	int height;
+};
+
+std::uint64_t align_offset(const std::uint64_t offset) {
+	return (offset + 15) & ~static_cast<std::uint64_t>(15);
+}
+
+// Average 2x2 blocks. Odd edges reuse their last row or column.
+Level downsample(const Level &level, const int channels) {
+	Level next;
+	next.width = std::max(level.width / 2, 1);
+	next.height = std::max(level.height / 2, 1);
+	next.pixels.resize(next.width * next.height * channels);
+
+	for(int y = 0; y < next.height; ++y) {
+		const int y0 = std::min(y * 2, level.height - 1);
+		const int y1 = std::min(y * 2 + 1, level.height - 1);
+		for(int x = 0; x < next.width; ++x) {
+			const int x0 = std::min(x * 2, level.width - 1);
+			const int x1 = std::min(x * 2 + 1, level.width - 1);
+			for(int c = 0; c < channels; ++c) {
+				const int sum = level.pixels[(y0 * level.width + x0) * channels + c] + level.pixels[(y0 * level.width + x1) * channels + c]
+					+ level.pixels[(y1 * level.width + x0) * channels + c] + level.pixels[(y1 * level.width + x1) * channels + c];
+				next.pixels[(y * next.width + x) * channels + c] = (sum + 2) / 4;
+			}
+		}
+	}
+
+	return next;
+}
+
+std::uint16_t pack_565(const int *color) {
+	return ((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255);
+}
+
+void unpack_565(const std::uint16_t packed, int *color) {
+	color[0] = (packed >> 11 & 31) * 255 / 31;
+	color[1] = (packed >> 5 & 63) * 255 / 63;
+	color[2] = (packed & 31) * 255 / 31;
+}
+
+// DXT1 colour block from 16 RGBA pixels, with endpoints at the corners of
+// the block's colour bounding box. Always uses the four colour mode.
+void encode_color_block(const unsigned char *block, unsigned char *out) {
+	int low[3] = {255, 255, 255};
+	int high[3] = {0, 0, 0};
+	for(int i = 0; i < 16; ++i) {
+		for(int c = 0; c < 3; ++c) {
+			low[c] = std::min(low[c], (int) block[i * 4 + c]);
+			high[c] = std::max(high[c], (int) block[i * 4 + c]);
+		}
+	}
+
+	std::uint16_t color0 = pack_565(high);
+	std::uint16_t color1 = pack_565(low);
+	if(color0 < color1) std::swap(color0, color1);
+
+	int palette[4][3];
+	unpack_565(color0, palette[0]);
+	unpack_565(color1, palette[1]);
+	for(int c = 0; c < 3; ++c) {
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	std::uint32_t indices = 0;
+	if(color0 != color1) {
+		for(int i = 0; i < 16; ++i) {
+			int best = 0;
+			int best_distance = 1 << 30;
+			for(int p = 0; p < 4; ++p) {
+				int distance = 0;
+				for(int c = 0; c < 3; ++c) {
+					const int d = block[i * 4 + c] - palette[p][c];
+					distance += d * d;
+				}
+				if(distance < best_distance) {
+					best = p;
+					best_distance = distance;
+				}
+			}
+			indices |= best << (i * 2);
+		}
+	}
+
+	out[0] = color0 & 0xFF;
+	out[1] = color0 >> 8;
+	out[2] = color1 & 0xFF;
+	out[3] = color1 >> 8;
+	for(int i = 0; i < 4; ++i) out[4 + i] = indices >> (i * 8) & 0xFF;
+}
+
+// DXT5 alpha block in the eight value mode
+void encode_alpha_block(const unsigned char *block, unsigned char *out) {
+	int alpha0 = 0;
+	int alpha1 = 255;
+	for(int i = 0; i < 16; ++i) {
+		alpha0 = std::max(alpha0, (int) block[i * 4 + 3]);
+		alpha1 = std::min(alpha1, (int) block[i * 4 + 3]);
+	}
+
+	int palette[8] = {alpha0, alpha1};
+	for(int p = 1; p < 7; ++p) palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+
+	std::uint64_t indices = 0;
+	if(alpha0 != alpha1) {
+		for(int i = 0; i < 16; ++i) {
+			int best = 0;
+			for(int p = 1; p < 8; ++p) {
+				if(std::abs(block[i * 4 + 3] - palette[p]) < std::abs(block[i * 4 + 3] - palette[best])) best = p;
+			}
+			indices |= static_cast<std::uint64_t>(best) << (i * 3);
+		}
+	}
+
+	out[0] = alpha0;
+	out[1] = alpha1;
+	for(int i = 0; i < 6; ++i) out[2 + i] = indices >> (i * 8) & 0xFF;
+}
+
+// Compress a level to DXT1, or DXT5 with alpha. Partial blocks at the edges
+// repeat their last row or column.
+std::vector<unsigned char> compress_level(const Level &level, const int channels, const bool alpha) {
+	const int blocks_x = (level.width + 3) / 4;
+	const int blocks_y = (level.height + 3) / 4;
+	const int block_size = alpha ? 16 : 8;
+	std::vector<unsigned char> compressed(blocks_x * blocks_y * block_size);
+
+	unsigned char block[64];
+	for(int by = 0; by < blocks_y; ++by) {
+		for(int bx = 0; bx < blocks_x; ++bx) {
+			for(int i = 0; i < 16; ++i) {
+				const int x = std::min(bx * 4 + i % 4, level.width - 1);
+				const int y = std::min(by * 4 + i / 4, level.height - 1);
+				const unsigned char *pixel = &level.pixels[(y * level.width + x) * channels];
+
+				// Grey and grey-alpha images spread their first channel over RGB
+				block[i * 4 + 0] = pixel[0];
+				block[i * 4 + 1] = channels >= 3 ? pixel[1] : pixel[0];
+				block[i * 4 + 2] = channels >= 3 ? pixel[2] : pixel[0];
+				block[i * 4 + 3] = channels == 4 ? pixel[3] : channels == 2 ? pixel[1] : 255;
+			}
+
+			unsigned char *out = &compressed[(by * blocks_x + bx) * block_size];
+			if(alpha) {
+				encode_alpha_block(block, out);
+				out += 8;
+			}
+			encode_color_block(block, out);
+		}
+	}
+
+	return compressed;
+}
+
+// Bytes a level must hold: tightly packed pixels, or whole 4x4 S3TC blocks.
+// 0 for compressed formats other than DXT1 to DXT5.
+std::uint64_t expected_level_size(const TextureFileHeader &header, const std::uint32_t level, const GLenum compressed_format) {
+	const std::uint64_t width = std::max(header.width >> level, 1u);
+	const std::uint64_t height = std::max(header.height >> level, 1u);
+	switch(compressed_format) {
+	case 0: return width * height * header.channels;
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		return (width + 3) / 4 * ((height + 3) / 4) * 8;
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		return (width + 3) / 4 * ((height + 3) / 4) * 16;
+	default: return 0;
+	}
+}
+
+} // namespace
+
+bool bake_texture_file(const char *source, const char *destination, const bool compress) {
+	int width, height, channels;
+	unsigned char *image = stbi_load(source, &width, &height, &channels, 0);
+	if(image == nullptr) {
+		ERROR("Image " << source << " could not be loaded");
+		return false;
+	}
+
+	std::vector<Level> levels(1);
+	levels[0].pixels.assign(image, image + width * height * channels);
+	levels[0].width = width;
+	levels[0].height = height;
+	stbi_image_free(image);
+
+	while(levels.back().width > 1 || levels.back().height > 1) {
+		levels.push_back(downsample(levels.back(), channels));
+	}
+
+	const bool alpha = channels == 2 || channels == 4;
+	std::vector<std::vector<unsigned char>> compressed;
+	if(compress) {
+		for(const Level &level : levels) compressed.push_back(compress_level(level, channels, alpha));
+	}
+
+	TextureFileHeader header;
+	std::memcpy(header.magic, TEXTURE_FILE_MAGIC, sizeof(header.magic));
+	header.version = TEXTURE_FILE_VERSION;
+	header.width = width;
+	header.height = height;
+	header.channels = channels;
+	header.num_levels = levels.size();
+	header.compressed_format = !compress ? 0 : alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	header.reserved = 0;
+
+	std::vector<TextureFileLevel> table(levels.size() + compressed.size());
+	std::uint64_t offset = sizeof(header) + table.size() * sizeof(TextureFileLevel);
+	for(std::size_t i = 0; i < table.size(); ++i) {
+		offset = align_offset(offset);
+		table[i].offset = offset;
+		table[i].size = i < levels.size() ? levels[i].pixels.size() : compressed[i - levels.size()].size();
+		offset += table[i].size;
+	}
+
+	// Write beside the destination and rename, so a crash never leaves half a file
+	const std::string temp_path = std::string(destination) + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(TextureFileLevel));
+		for(std::size_t i = 0; i < table.size(); ++i) {
+			const std::vector<unsigned char> &payload = i < levels.size() ? levels[i].pixels : compressed[i - levels.size()];
+			const char zeros[16] = {};
+			file.write(zeros, table[i].offset - file.tellp());
+			file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+		}
+		if(!file) {
+			ERROR("Could not write texture file " << temp_path);
+			return false;
+		}
+	}
+	std::rename(temp_path.c_str(), destination);
+
+	DEBUG("Baked " << source << ": " << width << "x" << height << ", " << levels.size() << " levels" << (compress ? ", compressed" : ""));
+	return true;
+}
+
+GLuint load_texture_file(const char *source) {
+	MappedFile file(source);
+	if(!file.is_open()) return 0;
+
+	const unsigned char *data = file.get_data();
+	TextureFileHeader header;
+	if(file.get_size() < sizeof(header)) {
+		ERROR("Texture file " << source << " is truncated");
+		return 0;
+	}
+	std::memcpy(&header, data, sizeof(header));
+	if(std::memcmp(header.magic, TEXTURE_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != TEXTURE_FILE_VERSION) {
+		ERROR("Texture file " << source << " is not a version " << TEXTURE_FILE_VERSION << " texture file");
+		return 0;
+	}
+
+	// Everything below is sized from the header, so check it describes a
+	// texture GL can take before trusting any of it
+	GLint internal_format;
+	GLenum format;
+	if(header.channels < 1 || header.channels > 4 || !get_texture_format(header.channels, internal_format, format)) {
+		ERROR("Texture file " << source << " has " << header.channels << " channels");
+		return 0;
+	}
+	const std::uint32_t max_size = std::numeric_limits<GLsizei>::max();
+	if(header.width == 0 || header.height == 0 || header.width > max_size || header.height > max_size) {
+		ERROR("Texture file " << source << " is " << header.width << "x" << header.height);
+		return 0;
+	}
+	std::uint32_t max_levels = 1;
+	while(std::max(header.width, header.height) >> max_levels != 0) ++max_levels;
+	if(header.num_levels == 0 || header.num_levels > max_levels) {
+		ERROR("Texture file " << source << " has " << header.num_levels << " levels, not 1 to " << max_levels);
+		return 0;
+	}
+	if(header.compressed_format != 0 && expected_level_size(header, 0, header.compressed_format) == 0) {
+		ERROR("Texture file " << source << " has unknown compressed format " << header.compressed_format);
+		return 0;
+	}
+
+	const bool compressed = header.compressed_format != 0 && GLEW_EXT_texture_compression_s3tc;
+	const std::size_t num_tables = header.compressed_format != 0 ? 2 : 1;
+	const std::size_t table_end = sizeof(header) + num_tables * header.num_levels * sizeof(TextureFileLevel);
+	if(file.get_size() < table_end) {
+		ERROR("Texture file " << source << " is truncated");
+		return 0;
+	}
+	const TextureFileLevel *levels = reinterpret_cast<const TextureFileLevel*>(data + sizeof(header));
+	if(compressed) levels += header.num_levels;
+	for(std::uint32_t i = 0; i < header.num_levels; ++i) {
+		// Compared without adding, so a huge offset cannot wrap around
+		if(levels[i].size > file.get_size() || levels[i].offset > file.get_size() - levels[i].size) {
+			ERROR("Texture file " << source << " is truncated");
+			return 0;
+		}
+		if(levels[i].size != expected_level_size(header, i, compressed ? header.compressed_format : 0)) {
+			ERROR("Texture file " << source << " level " << i << " is " << levels[i].size << " bytes, not "
+				<< expected_level_size(header, i, compressed ? header.compressed_format : 0));
+			return 0;
+		}
+	}
+
+	if(compressed) internal_format = header.compressed_format;
+
+	GLuint texture;
+	glGenTextures(1, &texture);
+	gl_state().bind_texture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	const bool immutable = GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+	if(immutable) glTexStorage2D(GL_TEXTURE_2D, header.num_levels, internal_format, header.width, header.height);
+	for(std::uint32_t i = 0; i < header.num_levels; ++i) {
+		const GLsizei width = std::max(header.width >> i, 1u);
+		const GLsizei height = std::max(header.height >> i, 1u);
+		const void *pixels = data + levels[i].offset;
+
+		if(compressed && immutable) {
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, width, height, internal_format, levels[i].size, pixels);
+		} else if(compressed) {
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, internal_format, width, height, 0, levels[i].size, pixels);
+		} else if(immutable) {
+			glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
+		} else {
+			glTexImage2D(GL_TEXTURE_2D, i, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+		}
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.num_levels - 1);
+	gl_state().bind_texture(GL_TEXTURE_2D, 0);
+
+	// The driver has copied the levels by now, so the mapping can go
+	return texture;
+}
+
+} // namespace boa
@@ -0,0 +1,51 @@
+#ifndef TEXTURE_FILE_H
+#define TEXTURE_FILE_H
+
+#include <cstdint>
+#include <iostream>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+
+namespace boa {
+
+// Baked texture container, written by bake_texture_file and read by
+// load_texture_file. Layout, in host byte order:
+//   TextureFileHeader
+//   TextureFileLevel[num_levels]      uncompressed chain, level 0 first
+//   TextureFileLevel[num_levels]      compressed chain, if compressed_format != 0
+//   payloads, each 16-byte aligned
+// Uncompressed levels are tightly packed rows of `channels` bytes per pixel.
+// Compressed levels are S3TC blocks: DXT1 for images without alpha, DXT5
+// otherwise. Level i is max(1, width >> i) by max(1, height >> i).
+const char TEXTURE_FILE_MAGIC[4] = {'B', 'O', 'A', 'T'};
+const std::uint32_t TEXTURE_FILE_VERSION = 1;
+
+struct TextureFileHeader {
+	char magic[4];
+	std::uint32_t version;
+	std::uint32_t width;
+	std::uint32_t height;
+	std::uint32_t channels;
+	std::uint32_t num_levels;
+	std::uint32_t compressed_format; // GL enum of the compressed chain, or 0
+	std::uint32_t reserved;
+};
+
+struct TextureFileLevel {
+	std::uint64_t offset; // From the start of the file
+	std::uint64_t size;
+};
+
+// Decode an image, build its full mip chain with a box filter and write it
+// out, along with a compressed chain if asked. Meant for offline baking.
+bool bake_texture_file(const char *source, const char *destination, const bool compress = true);
+
+// Map a baked file and upload every level straight from the mapping. The
+// compressed chain is used when the driver supports S3TC. Returns 0 on failure.
+GLuint load_texture_file(const char *source);
+
+} // namespace boa
+
+#endif // TEXTURE_FILE_H
@@ -0,0 +1,153 @@
+#include "texture_loader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <stb_image.h>
+
+#include "boa_fns.h"
+#include "gl_state.h"
+#include "profiler.h"
+
+namespace boa {
+
+TextureLoader::TextureLoader(ThreadPool &pool, const int upload_budget, const bool immutable) : pool(pool) {
+	pbo_size = 0;
+	this->upload_budget = upload_budget;
+	this->immutable = immutable && (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage);
+
+	glGenBuffers(1, &pbo);
+}
+
+TextureLoader::~TextureLoader() {
+	// Workers write into decoded, so they must be done before it goes away
+	pool.wait();
+
+	for(const Decoded &image : decoded) stbi_image_free(image.pixels);
+	for(const Decoded &image : uploads) stbi_image_free(image.pixels);
+	for(const Entry &entry : entries) {
+		if(entry.texture != 0) gl_state().delete_textures(1, &entry.texture);
+	}
+	gl_state().delete_buffers(1, &pbo);
+}
+
+int TextureLoader::load(const std::string &path, const bool mipmaps) {
+	const int handle = entries.size();
+	Entry entry;
+	glGenTextures(1, &entry.texture);
+	entry.state = TextureState::LOADING;
+	entry.mipmaps = mipmaps;
+	entries.push_back(entry);
+
+	pool.submit([this, handle, path] {
+		Decoded image;
+		image.handle = handle;
+		image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+		if(image.pixels == nullptr) ERROR("Image " << path << " could not be loaded");
+
+		std::lock_guard<std::mutex> lock(decoded_mutex);
+		decoded.push_back(image);
+	});
+
+	return handle;
+}
+
+// Stream the pixels through the PBO, so glTex(Sub)Image2D copies from GPU
+// visible memory instead of blocking on client memory
+void TextureLoader::upload(const Decoded &image) {
+	Entry &entry = entries[image.handle];
+	const int size = image.width * image.height * image.channels;
+
+	gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+	pbo_size = std::max(pbo_size, size);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, pbo_size, nullptr, GL_STREAM_DRAW); // Orphans the previous upload
+	void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if(mapped == nullptr) {
+		ERROR("Could not map the texture upload buffer");
+		gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		entry.state = TextureState::FAILED;
+		return;
+	}
+	std::memcpy(mapped, image.pixels, size);
+	PROFILE_UPLOAD(size);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	GLint internal_format;
+	GLenum format;
+	get_texture_format(image.channels, internal_format, format);
+
+	gl_state().bind_texture(GL_TEXTURE_2D, entry.texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if(immutable) {
+		const int levels = entry.mipmaps ? (int) std::log2(std::max(image.width, image.height)) + 1 : 1;
+		glTexStorage2D(GL_TEXTURE_2D, levels, internal_format, image.width, image.height);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width, image.height, format, GL_UNSIGNED_BYTE, 0);
+	} else {
+		glTexImage2D(GL_TEXTURE_2D, 0, internal_format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, 0);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	if(entry.mipmaps) {
+		glGenerateMipmap(GL_TEXTURE_2D);
+	} else {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	}
+	gl_state().bind_texture(GL_TEXTURE_2D, 0);
+	gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	entry.state = TextureState::READY;
+}
+
+int TextureLoader::update() {
+	{
+		std::lock_guard<std::mutex> lock(decoded_mutex);
+		uploads.insert(uploads.end(), decoded.begin(), decoded.end());
+		decoded.clear();
+	}
+
+	int spent = 0;
+	int num_ready = 0;
+	std::size_t next = 0;
+	for(; next < uploads.size() && (next == 0 || spent < upload_budget); ++next) {
+		const Decoded &image = uploads[next];
+		Entry &entry = entries[image.handle];
+
+		if(entry.state == TextureState::RELEASED) {
+			// Released while decoding, nothing to upload
+		} else if(image.pixels == nullptr) {
+			entry.state = TextureState::FAILED;
+		} else {
+			upload(image);
+			spent += image.width * image.height * image.channels;
+			if(entry.state == TextureState::READY) ++num_ready;
+		}
+		stbi_image_free(image.pixels);
+	}
+	uploads.erase(uploads.begin(), uploads.begin() + next);
+
+	return num_ready;
+}
+
+void TextureLoader::release(const int handle) {
+	Entry &entry = entries[handle];
+	if(entry.texture != 0) gl_state().delete_textures(1, &entry.texture);
+	entry.texture = 0;
+	entry.state = TextureState::RELEASED;
+}
+
+TextureState TextureLoader::get_state(const int handle) { return entries[handle].state; }
+bool TextureLoader::is_ready(const int handle) { return entries[handle].state == TextureState::READY; }
+GLuint TextureLoader::get_texture(const int handle) { return entries[handle].texture; }
+
+int TextureLoader::get_num_loading() {
+	int num_loading = 0;
+	for(const Entry &entry : entries) {
+		if(entry.state == TextureState::LOADING) ++num_loading;
+	}
+	return num_loading;
+}
+
+void TextureLoader::set_upload_budget(const int bytes) { upload_budget = bytes; }
+
+} // namespace boa
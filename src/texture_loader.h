@@ -0,0 +1,85 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+#include "thread_pool.h"
+
+namespace boa {
+
+enum class TextureState {
+	LOADING, // Being decoded, or decoded and waiting for its upload
+	READY, // Uploaded and usable
+	FAILED, // The image could not be decoded
+	RELEASED // Released, so it will never have a texture
+};
+
+// Loads textures without stalling the GL thread. Images are decoded on a
+// thread pool, then update() uploads them through a pixel buffer object,
+// stopping each frame once the upload budget is spent. A handle's texture
+// name exists from the start so it can be bound right away; it samples as
+// incomplete (black) until it is ready. Formats follow the decoded channel
+// count, and immutable storage is used where available unless disabled.
+// Textures belong to the loader and are deleted with it.
+class TextureLoader {
+private:
+	struct Entry {
+		GLuint texture;
+		TextureState state;
+		bool mipmaps;
+	};
+
+	struct Decoded {
+		int handle;
+		unsigned char *pixels;
+		int width;
+		int height;
+		int channels;
+	};
+
+	ThreadPool &pool;
+	std::vector<Entry> entries;
+
+	std::mutex decoded_mutex;
+	std::vector<Decoded> decoded; // Filled by workers, drained by update()
+	std::vector<Decoded> uploads; // Decoded images waiting on the budget, oldest first
+
+	GLuint pbo;
+	int pbo_size;
+	int upload_budget; // Bytes per update()
+	bool immutable;
+
+	void upload(const Decoded &image);
+public:
+	TextureLoader(ThreadPool &pool, const int upload_budget = 4 << 20, const bool immutable = true);
+	TextureLoader(const TextureLoader&) = delete;
+	~TextureLoader(); // Waits for the pool to finish decoding
+
+	TextureLoader &operator=(const TextureLoader&) = delete;
+
+	// Start loading an image file, returning its handle
+	int load(const std::string &path, const bool mipmaps = true);
+
+	// Upload decoded images until the budget is spent. At least one image is
+	// uploaded per call, however large. Returns how many became ready.
+	int update();
+
+	void release(const int handle);
+
+	TextureState get_state(const int handle);
+	bool is_ready(const int handle);
+	GLuint get_texture(const int handle);
+	int get_num_loading();
+
+	void set_upload_budget(const int bytes);
+};
+
+} // namespace boa
+
+#endif // TEXTURE_LOADER_H
@@ -0,0 +1,114 @@
+#include "thread_pool.h"
+
+namespace boa {
+
+// Pool and queue of the worker running on this thread, if any
+thread_local ThreadPool *current_pool = nullptr;
+thread_local unsigned current_queue = 0;
+
+ThreadPool::ThreadPool(unsigned num_threads) : pending(0), queued(0), next_queue(0), stopping(false) {
+	queues.resize(std::max(num_threads, 1u));
+	for(auto &queue : queues) queue.reset(new Queue);
+
+	for(unsigned i = 0; i < num_threads; ++i) {
+		workers.emplace_back(&ThreadPool::work, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for(std::thread &worker : workers) worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+	const unsigned queue_index = current_pool == this ? current_queue : next_queue++ % queues.size();
+
+	++pending;
+	{
+		std::lock_guard<std::mutex> lock(queues[queue_index]->mutex);
+		queues[queue_index]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex);
+		++queued;
+	}
+	wake.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::function<void()> task;
+	while(pending > 0) {
+		if(steal(0, task) || pop(0, task)) {
+			run(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wake_mutex);
+		wake.wait(lock, [&] { return pending == 0 || queued > 0; });
+	}
+}
+
+unsigned ThreadPool::get_num_threads() { return workers.size(); }
+
+// Take the newest task from a queue
+bool ThreadPool::pop(const unsigned queue_index, std::function<void()> &task) {
+	Queue &queue = *queues[queue_index];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if(queue.tasks.empty()) return false;
+
+	task = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+	--queued;
+	return true;
+}
+
+// Take the oldest task from any queue but the given one
+bool ThreadPool::steal(const unsigned queue_index, std::function<void()> &task) {
+	const unsigned num_queues = queues.size();
+	for(unsigned i = 1; i < num_queues; ++i) {
+		Queue &queue = *queues[(queue_index + i) % num_queues];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(queue.tasks.empty()) continue;
+
+		task = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+		--queued;
+		return true;
+	}
+
+	return false;
+}
+
+void ThreadPool::run(std::function<void()> &task) {
+	task();
+	task = nullptr;
+
+	if(--pending == 0) {
+		std::lock_guard<std::mutex> lock(wake_mutex);
+		wake.notify_all();
+	}
+}
+
+void ThreadPool::work(const unsigned worker_index) {
+	current_pool = this;
+	current_queue = worker_index;
+
+	std::function<void()> task;
+	while(true) {
+		if(pop(worker_index, task) || steal(worker_index, task)) {
+			run(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wake_mutex);
+		wake.wait(lock, [&] { return stopping || queued > 0; });
+		if(stopping && queued == 0) return;
+	}
+}
+
+} // namespace boa
@@ -0,0 +1,55 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace boa {
+
+// Work-stealing thread pool.
+// Each worker owns a task queue and runs its newest task first; idle workers
+// steal the oldest task from the others. Tasks submitted from a worker stay
+// on that worker's queue, others are spread round-robin.
+class ThreadPool {
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+
+	std::mutex wake_mutex;
+	std::condition_variable wake;
+	std::atomic<int> pending; // Submitted but not finished
+	std::atomic<int> queued; // Submitted but not started
+	std::atomic<unsigned> next_queue;
+	bool stopping;
+
+	bool pop(const unsigned queue_index, std::function<void()> &task);
+	bool steal(const unsigned queue_index, std::function<void()> &task);
+	void run(std::function<void()> &task);
+	void work(const unsigned worker_index);
+public:
+	ThreadPool(unsigned num_threads = std::thread::hardware_concurrency());
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool &operator=(const ThreadPool&) = delete;
+
+	void submit(std::function<void()> task);
+	void wait(); // Blocks until every submitted task has run. The calling thread helps.
+
+	unsigned get_num_threads();
+};
+
+} // namespace boa
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,137 @@
+#include "triangulation_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "gl_data.h"
+#include "predicates.h"
+
+namespace boa {
+
+// Grid the normalized coordinates are snapped to before hashing. Coarse
+// enough that float rounding in translated copies rarely changes a cell.
+const double SHAPE_HASH_QUANTUM = 1.0 / (1 << 10);
+// Largest difference in normalized coordinates for two shapes to share a
+// triangulation
+const float SHAPE_TOLERANCE = 1.0f / (1 << 17);
+
+TriangulationCache::TriangulationCache(const std::size_t max_bytes) {
+	this->max_bytes = max_bytes;
+	size_bytes = 0;
+	hits = 0;
+	misses = 0;
+}
+
+std::uint64_t TriangulationCache::make_key(const GLfloat *vertices, const int num_verts, const int stride, std::vector<GLfloat> &shape) {
+	double min_x = vertices[0], min_y = vertices[1];
+	double max_x = min_x, max_y = min_y;
+	for(int i = 1; i < num_verts; ++i) {
+		min_x = std::min(min_x, (double) vertices[i * stride]);
+		max_x = std::max(max_x, (double) vertices[i * stride]);
+		min_y = std::min(min_y, (double) vertices[i * stride + 1]);
+		max_y = std::max(max_y, (double) vertices[i * stride + 1]);
+	}
+
+	const double extent = std::max(max_x - min_x, max_y - min_y);
+	const double scale = extent > 0 ? 1 / extent : 0;
+
+	// FNV-1a over the quantized coordinates
+	std::uint64_t hash = 14695981039346656037ull;
+	const auto mix = [&] (std::uint32_t value) {
+		for(int i = 0; i < 4; ++i) {
+			hash ^= value & 0xff;
+			hash *= 1099511628211ull;
+			value >>= 8;
+		}
+	};
+
+	shape.resize(num_verts * 2);
+	mix(num_verts);
+	for(int i = 0; i < num_verts * 2; ++i) {
+		shape[i] = (vertices[i / 2 * stride + i % 2] - (i % 2 ? min_y : min_x)) * scale;
+		mix(std::lround(shape[i] / SHAPE_HASH_QUANTUM));
+	}
+
+	return hash;
+}
+
+bool TriangulationCache::find(const std::uint64_t hash, const std::vector<GLfloat> &shape, const GLfloat *vertices, const int stride,
+	GLuint *indices, const int num_elements, TriangulationPath &path) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	static thread_local std::vector<signed char> signs;
+	const auto matches = [&] (const Entry &entry) -> bool {
+		if(entry.shape.size() != shape.size() || (int) entry.indices.size() != num_elements) return false;
+		for(std::size_t i = 0; i < shape.size(); ++i) {
+			if(std::abs(entry.shape[i] - shape[i]) > SHAPE_TOLERANCE) return false;
+		}
+
+		// Any triangle turning the other way, or collapsing, means the stored
+		// triangulation does not fit these vertices
+		signs.resize(entry.signs.size());
+		orient2d_triangles(vertices, stride, entry.indices.data(), signs.size(), signs.data());
+		return signs == entry.signs;
+	};
+
+	const auto found = lookup.find(hash);
+	if(found == lookup.end() || !matches(*found->second)) {
+		++misses;
+		return false;
+	}
+
+	entries.splice(entries.begin(), entries, found->second);
+	std::memcpy(indices, found->second->indices.data(), sizeof(GLuint) * num_elements);
+	path = found->second->path;
+	++hits;
+
+	return true;
+}
+
+void TriangulationCache::insert(const std::uint64_t hash, const std::vector<GLfloat> &shape, const GLfloat *vertices, const int stride,
+	const GLuint *indices, const int num_elements, const TriangulationPath path) {
+	std::vector<signed char> signs(num_elements / 3);
+	orient2d_triangles(vertices, stride, indices, signs.size(), signs.data());
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// A hash collision replaces the older shape
+	const auto found = lookup.find(hash);
+	if(found != lookup.end()) {
+		size_bytes -= found->second->bytes();
+		entries.erase(found->second);
+		lookup.erase(found);
+	}
+
+	entries.push_front(Entry{hash, shape, std::vector<GLuint>(indices, indices + num_elements), std::move(signs), path});
+	lookup[hash] = entries.begin();
+	size_bytes += entries.front().bytes();
+
+	evict();
+}
+
+void TriangulationCache::clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	entries.clear();
+	lookup.clear();
+	size_bytes = 0;
+}
+
+// Drop least recently used entries until the cache fits in max_bytes
+void TriangulationCache::evict() {
+	while(size_bytes > max_bytes && !entries.empty()) {
+		DEBUG("Evicting cached triangulation " << entries.back().hash);
+		size_bytes -= entries.back().bytes();
+		lookup.erase(entries.back().hash);
+		entries.pop_back();
+	}
+}
+
+std::size_t TriangulationCache::get_hits() { std::lock_guard<std::mutex> lock(mutex); return hits; }
+std::size_t TriangulationCache::get_misses() { std::lock_guard<std::mutex> lock(mutex); return misses; }
+std::size_t TriangulationCache::get_size_bytes() { std::lock_guard<std::mutex> lock(mutex); return size_bytes; }
+std::size_t TriangulationCache::get_num_entries() { std::lock_guard<std::mutex> lock(mutex); return entries.size(); }
+
+} // namespace boa
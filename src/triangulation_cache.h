@@ -0,0 +1,76 @@
+#ifndef TRIANGULATION_CACHE_H
+#define TRIANGULATION_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "boa_global.h"
+
+namespace boa {
+
+enum class TriangulationPath;
+
+// Remembers the index buffers of polygons that have already been triangulated.
+// Rings are keyed by their shape alone: vertices are translated so the
+// bounding box starts at the origin and scaled so its longest side is 1. The
+// hash uses a coarse grid and hits are confirmed against the stored shape
+// within a small tolerance, so copies of an outline at any position or
+// uniform scale share an entry. A hit must also leave every triangle turning
+// the way it did for the polygon that was cached, as a vertex moved within
+// the tolerance can still flip a thin triangle. Least recently used entries
+// are evicted once the cache holds more than max_bytes. Safe to share
+// between threads.
+class TriangulationCache {
+private:
+	struct Entry {
+		std::uint64_t hash;
+		std::vector<GLfloat> shape;
+		std::vector<GLuint> indices;
+		std::vector<signed char> signs; // Turn of each triangle: -1, 0 or 1
+		TriangulationPath path;
+
+		std::size_t bytes() const {
+			return sizeof(Entry) + sizeof(GLfloat) * shape.size() + sizeof(GLuint) * indices.size() + signs.size();
+		}
+	};
+
+	std::list<Entry> entries; // Most recently used first
+	std::unordered_map<std::uint64_t, std::list<Entry>::iterator> lookup;
+	std::mutex mutex;
+
+	std::size_t max_bytes;
+	std::size_t size_bytes;
+	std::size_t hits;
+	std::size_t misses;
+
+	void evict();
+public:
+	TriangulationCache(const std::size_t max_bytes);
+	TriangulationCache(const TriangulationCache&) = delete;
+	TriangulationCache &operator=(const TriangulationCache&) = delete;
+
+	// Build the shape key of a ring stored with the given stride. Returns its hash.
+	static std::uint64_t make_key(const GLfloat *vertices, const int num_verts, const int stride, std::vector<GLfloat> &shape);
+
+	// Both take the ring's vertices as given to make_key, to check orientations
+	bool find(const std::uint64_t hash, const std::vector<GLfloat> &shape, const GLfloat *vertices, const int stride,
+		GLuint *indices, const int num_elements, TriangulationPath &path);
+	void insert(const std::uint64_t hash, const std::vector<GLfloat> &shape, const GLfloat *vertices, const int stride,
+		const GLuint *indices, const int num_elements, const TriangulationPath path);
+	void clear();
+
+	std::size_t get_hits();
+	std::size_t get_misses();
+	std::size_t get_size_bytes();
+	std::size_t get_num_entries();
+};
+
+} // namespace boa
+
+#endif // TRIANGULATION_CACHE_H
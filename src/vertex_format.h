@@ -0,0 +1,152 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "gl_data.h"
+
+namespace boa {
+
+// Vertex attributes, each a run of GLfloats in the interleaved vertex.
+// Exactly one attribute per format must be a position; it is what gets
+// triangulated.
+template<int Size, bool Position = false, GLboolean Normalized = GL_FALSE> struct Attribute {
+	static constexpr int size = Size;
+	static constexpr bool position = Position;
+	static constexpr GLboolean normalized = Normalized;
+};
+
+struct Position2 : Attribute<2, true> {};
+struct Position3 : Attribute<3, true> {}; // z is written as zero
+struct ColorRGB : Attribute<3> {};
+struct ColorRGBA : Attribute<4> {};
+struct TexCoord2 : Attribute<2> {};
+struct Normal3 : Attribute<3> {};
+
+// Runtime description of an attribute, for layouts read from files
+struct VertexAttribute {
+	GLint size;
+	GLint offset; // GLfloats before the attribute in each vertex
+	GLboolean normalized;
+	bool position;
+};
+
+// Interleaved layout of a list of attributes, computed at compile time.
+// Attribute locations follow list order starting from 0.
+template<typename... Attributes> struct VertexFormat {
+private:
+	template<typename... List> struct Sum {
+		static constexpr int size = 0;
+		static constexpr int positions = 0;
+	};
+	template<typename First, typename... Rest> struct Sum<First, Rest...> {
+		static constexpr int size = First::size + Sum<Rest...>::size;
+		static constexpr int positions = First::position + Sum<Rest...>::positions;
+	};
+
+	// Offset of the first Target in List, or of the end of List if it is absent
+	template<typename Target, typename... List> struct Find {
+		static constexpr int offset = 0;
+		static constexpr int location = 0;
+	};
+	template<typename Target, typename First, typename... Rest> struct Find<Target, First, Rest...> {
+		static constexpr bool found = std::is_same<Target, First>::value;
+		static constexpr int offset = found ? 0 : First::size + Find<Target, Rest...>::offset;
+		static constexpr int location = found ? 0 : 1 + Find<Target, Rest...>::location;
+	};
+
+	// Whether any attribute appears more than once in List
+	template<typename... List> struct Repeats {
+		static constexpr bool any = false;
+	};
+	template<typename First, typename... Rest> struct Repeats<First, Rest...> {
+		static constexpr bool any = Find<First, Rest...>::location < (int) sizeof...(Rest) || Repeats<Rest...>::any;
+	};
+
+	// Offset and size of the position attribute
+	template<typename... List> struct Position {
+		static constexpr int offset = 0;
+		static constexpr int size = 0;
+	};
+	template<typename First, typename... Rest> struct Position<First, Rest...> {
+		static constexpr int offset = First::position ? 0 : First::size + Position<Rest...>::offset;
+		static constexpr int size = First::position ? First::size : Position<Rest...>::size;
+	};
+
+	template<typename A> static void set_attribute_pointer(const GLuint first_location) {
+		glVertexAttribPointer(first_location + location<A>(), A::size, GL_FLOAT, A::normalized,
+			stride * sizeof(GLfloat), (GLvoid*) (offset<A>() * sizeof(GLfloat)));
+		glEnableVertexAttribArray(first_location + location<A>());
+	}
+
+public:
+	static constexpr int stride = Sum<Attributes...>::size; // GLfloats per vertex
+	static constexpr int num_attributes = sizeof...(Attributes);
+	static constexpr int position_offset = Position<Attributes...>::offset;
+	static constexpr int position_size = Position<Attributes...>::size;
+
+	static_assert(Sum<Attributes...>::positions == 1, "A vertex format needs exactly one position attribute");
+	static_assert(!Repeats<Attributes...>::any, "Attributes are looked up by type, so each may appear only once");
+
+	template<typename A> static constexpr int offset() {
+		static_assert(Find<A, Attributes...>::location < num_attributes, "Attribute is not part of this vertex format");
+		return Find<A, Attributes...>::offset;
+	}
+
+	template<typename A> static constexpr int location() {
+		static_assert(Find<A, Attributes...>::location < num_attributes, "Attribute is not part of this vertex format");
+		return Find<A, Attributes...>::location;
+	}
+
+	// Describe every attribute to the bound vertex array and array buffer
+	static void set_attribute_pointers(const GLuint first_location = 0) {
+		const int expand[] = {(set_attribute_pointer<Attributes>(first_location), 0)...};
+		(void) expand;
+	}
+
+	static std::vector<VertexAttribute> get_attributes() {
+		return {{Attributes::size, offset<Attributes>(), Attributes::normalized, Attributes::position}...};
+	}
+};
+
+// GLData laid out by a VertexFormat, e.g. TypedGLData<Position2, ColorRGB>.
+// Attributes are filled by type with fixed-size strided copies, and the VAO
+// attribute setup comes from the same layout.
+template<typename... Attributes> class TypedGLData : public GLData {
+public:
+	using Format = VertexFormat<Attributes...>;
+
+	TypedGLData(const Vertices &vertices, BufferAllocator *allocator = nullptr, TriangulationCache *cache = nullptr)
+		: GLData(&vertices, 1, Format::stride, Format::position_offset, Format::position_size, allocator, cache) {}
+	TypedGLData(const std::vector<Vertices> &rings, BufferAllocator *allocator = nullptr, TriangulationCache *cache = nullptr)
+		: GLData(rings.data(), rings.size(), Format::stride, Format::position_offset, Format::position_size, allocator, cache) {}
+
+	// Copy one value per vertex into attribute A. Values can be any indexable
+	// container of tightly packed GLfloat vectors, such as glm::vec3.
+	template<typename A, typename Container> TypedGLData &set(const Container &values) {
+		static_assert(!A::position, "Positions are set by gen_gl_data and update_vertices");
+		static_assert(std::is_same<typename std::decay<decltype(values[0][0])>::type, GLfloat>::value, "Attribute values must be GLfloat vectors");
+		static_assert(sizeof(values[0]) == A::size * sizeof(GLfloat), "Attribute values must match the attribute size");
+		assert((int) values.size() >= get_num_verts());
+
+		GLfloat *vertex = get_vertices() + Format::template offset<A>();
+		for(int i = 0, num_verts = get_num_verts(); i < num_verts; ++i, vertex += Format::stride) {
+			std::memcpy(vertex, &values[i][0], A::size * sizeof(GLfloat));
+		}
+
+		return *this;
+	}
+
+	// Describe this format to the bound vertex array and array buffer
+	static void set_attribute_pointers(const GLuint first_location = 0) {
+		Format::set_attribute_pointers(first_location);
+	}
+};
+
+} // namespace boa
+
+#endif // VERTEX_FORMAT_H
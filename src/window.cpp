@@ -0,0 +1,40 @@
+#include "window.h"
+
+#include "gl_state.h"
+
+namespace boa {
+
+// General
+bool init(GLint version_major, GLint version_minor, GLboolean resizable) {
+	// Initialize GLFW
+	glfwInit();
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version_major);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version_minor);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_RESIZABLE, resizable);
+
+	glewExperimental = GL_TRUE;
+
+	return true; // TODO: Should return false if initialization fails
+}
+
+
+// Windows
+GLFWwindow* create_window(int width, int height, std::string name, GLFWmonitor* monitor, GLFWwindow* share) {
+	GLFWwindow* window = glfwCreateWindow(width, height, name.c_str(), monitor, share);
+	if(window == nullptr) {
+		ERROR("Failed to create window \"" << name << "\"");
+	}
+
+	glfwMakeContextCurrent(window);
+	gl_state().invalidate(); // The shadow copy may describe another context
+
+	if(glewInit() != GLEW_OK) {
+		ERROR("Failed to initialize GLEW for window \"" << name << "\"");
+	}
+
+	return window;
+}
+
+} // boa
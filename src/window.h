@@ -0,0 +1,24 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <iostream>
+#include <string>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "boa_global.h"
+
+// GLFW helpers, kept out of boa_fns.h so headless programs need no GLFW
+
+namespace boa {
+
+// General
+bool init(GLint version_major, GLint version_minor, GLboolean resizable);
+
+// Windows
+GLFWwindow* create_window(int width, int height, std::string name, GLFWmonitor* monitor = nullptr, GLFWwindow* share = nullptr);
+
+} // boa
+
+#endif // WINDOW_H
@@ -6,8 +6,10 @@ layout (location = 1) in vec3 in_color;
 out vec3 vert_color;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform Camera {
+	mat4 view;
+	mat4 projection;
+};
 
 void main() {
 	gl_Position = projection * view * model * vec4(position, 1.0);
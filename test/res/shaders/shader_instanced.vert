@@ -0,0 +1,22 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 in_color;
+layout (location = 2) in vec4 instance_transform; // x, y, rotation, scale
+layout (location = 3) in vec4 instance_tint;
+
+out vec3 vert_color;
+
+layout (std140) uniform Camera {
+	mat4 view;
+	mat4 projection;
+};
+
+void main() {
+	float c = cos(instance_transform.z);
+	float s = sin(instance_transform.z);
+	vec2 world = instance_transform.w * (mat2(c, s, -s, c) * position.xy) + instance_transform.xy;
+
+	gl_Position = projection * view * vec4(world, position.z, 1.0);
+	vert_color = in_color * instance_tint.rgb;
+}
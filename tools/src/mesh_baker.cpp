@@ -0,0 +1,48 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <boa/boa.h>
+
+// Triangulates polygons into mesh files for boa::MeshFile. The input lists
+// one "x y" vertex per line, in order around the polygon. Vertices are baked
+// as Position3 and ColorRGB, the layout of the test shaders.
+// Usage: mesh_baker [--color r g b] <polygon> <output> [<polygon> <output> ...]
+int main(int argc, char *argv[]) {
+	glm::vec3 color(1.0f, 1.0f, 1.0f);
+	int first = 1;
+	if(argc > 4 && std::strcmp(argv[1], "--color") == 0) {
+		color = glm::vec3(std::atof(argv[2]), std::atof(argv[3]), std::atof(argv[4]));
+		first += 4;
+	}
+
+	if(argc - first < 2 || (argc - first) % 2 != 0) {
+		std::cerr << "Usage: " << argv[0] << " [--color r g b] <polygon> <output> [<polygon> <output> ...]" << std::endl;
+		return 1;
+	}
+
+	int failures = 0;
+	for(int i = first; i < argc; i += 2) {
+		std::ifstream input(argv[i]);
+		boa::Vertices vertices;
+		float x, y;
+		while(input >> x >> y) vertices.push_back(glm::vec4(x, y, 0.0f, 0.0f));
+		if(vertices.size() < 3) {
+			std::cerr << argv[i] << ": a polygon needs at least 3 vertices" << std::endl;
+			++failures;
+			continue;
+		}
+
+		boa::TypedGLData<boa::Position3, boa::ColorRGB> data(vertices);
+		data.set<boa::ColorRGB>(std::vector<glm::vec3>(vertices.size(), color));
+		if(boa::write_mesh_file(data, argv[i + 1])) {
+			std::cout << argv[i] << " -> " << argv[i + 1] << " (" << data.get_num_elements() / 3 << " triangles)" << std::endl;
+		} else {
+			++failures;
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Not boa.h, which brings in the GLFW window helpers
+#include <boa/boa_fns.h>
+#include <boa/headless_context.h>
+#include <boa/mesh.h>
+#include <boa/program.h>
+#include <boa/readback_ring.h>
+#include <boa/render_target.h>
+#include <boa/vertex_format.h>
+
+// Renders polygons to PPM thumbnails without a window or display. The input
+// lists one "x y" vertex per line, like mesh_baker's. Each polygon is scaled
+// to fit the image and filled in white on black. Readbacks are pipelined, so
+// polygon N is drawn while polygon N-2 is read back and written.
+// Usage: polygon_thumbnail [--size pixels] <polygon> <output> [<polygon> <output> ...]
+
+namespace {
+
+const char *VERTEX_SHADER =
+	"#version 330 core\n"
+	"layout (location = 0) in vec2 position;\n"
+	"void main() { gl_Position = vec4(position, 0.0, 1.0); }\n";
+
+const char *FRAGMENT_SHADER =
+	"#version 330 core\n"
+	"out vec4 color;\n"
+	"void main() { color = vec4(1.0); }\n";
+
+// Centred in [-0.9, 0.9], keeping the aspect ratio
+void fit(boa::Vertices &vertices) {
+	glm::vec2 low(vertices[0][0], vertices[0][1]);
+	glm::vec2 high = low;
+	for(const glm::vec4 &vertex : vertices) {
+		low = glm::vec2(std::min(low.x, vertex[0]), std::min(low.y, vertex[1]));
+		high = glm::vec2(std::max(high.x, vertex[0]), std::max(high.y, vertex[1]));
+	}
+
+	const float extent = std::max(std::max(high.x - low.x, high.y - low.y), 1e-6f);
+	for(glm::vec4 &vertex : vertices) {
+		vertex[0] = ((vertex[0] - low.x) * 2.0f - (high.x - low.x)) / extent * 0.9f;
+		vertex[1] = ((vertex[1] - low.y) * 2.0f - (high.y - low.y)) / extent * 0.9f;
+	}
+}
+
+// Binary PPM, flipped so the first row read back ends up at the bottom
+bool write_ppm(const char *path, const unsigned char *pixels, const int size) {
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	file << "P6\n" << size << " " << size << "\n255\n";
+
+	std::vector<char> row(size * 3);
+	for(int y = size - 1; y >= 0; --y) {
+		for(int x = 0; x < size; ++x) {
+			const unsigned char *pixel = &pixels[(y * size + x) * 4];
+			row[x * 3] = pixel[0];
+			row[x * 3 + 1] = pixel[1];
+			row[x * 3 + 2] = pixel[2];
+		}
+		file.write(row.data(), row.size());
+	}
+
+	if(!file) {
+		std::cerr << path << ": could not be written" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	int size = 256;
+	int first = 1;
+	if(argc > 2 && std::strcmp(argv[1], "--size") == 0) {
+		size = std::max(1, std::atoi(argv[2]));
+		first += 2;
+	}
+
+	if(argc - first < 2 || (argc - first) % 2 != 0) {
+		std::cerr << "Usage: " << argv[0] << " [--size pixels] <polygon> <output> [<polygon> <output> ...]" << std::endl;
+		return 1;
+	}
+
+	boa::HeadlessContext context(3, 3);
+	if(!context.is_valid()) return 1;
+
+	int failures = 0;
+	{
+		const GLuint vertex_shader = boa::compile_shader_source(VERTEX_SHADER, GL_VERTEX_SHADER, "thumbnail vertex shader");
+		const GLuint fragment_shader = boa::compile_shader_source(FRAGMENT_SHADER, GL_FRAGMENT_SHADER, "thumbnail fragment shader");
+		boa::Program program({vertex_shader, fragment_shader});
+		glDeleteShader(vertex_shader);
+		glDeleteShader(fragment_shader);
+
+		boa::RenderTarget target(size, size);
+		boa::ReadbackRing ring(size, size);
+		if(!program.is_linked() || !target.is_complete()) return 1;
+
+		// Ids are indices into argv of the input polygon
+		auto collect = [&](const bool wait) {
+			std::uint64_t id;
+			const unsigned char *pixels = ring.map_oldest(id, wait);
+			if(pixels == nullptr || !write_ppm(argv[id + 1], pixels, size)) {
+				++failures;
+			} else {
+				std::cout << argv[id] << " -> " << argv[id + 1] << std::endl;
+			}
+			ring.unmap_oldest();
+		};
+
+		for(int i = first; i < argc; i += 2) {
+			std::ifstream input(argv[i]);
+			boa::Vertices vertices;
+			float x, y;
+			while(input >> x >> y) vertices.push_back(glm::vec4(x, y, 0.0f, 0.0f));
+			if(vertices.size() < 3) {
+				std::cerr << argv[i] << ": a polygon needs at least 3 vertices" << std::endl;
+				++failures;
+				continue;
+			}
+			fit(vertices);
+
+			boa::TypedGLData<boa::Position2> data(vertices);
+			boa::Mesh mesh(data);
+
+			target.bind();
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			program.use();
+			mesh.draw();
+
+			ring.queue(target.get_framebuffer(), i);
+			if(ring.is_full()) collect(true);
+		}
+		while(!ring.is_empty()) collect(true);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
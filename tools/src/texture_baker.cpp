@@ -0,0 +1,31 @@
+#include <cstring>
+#include <iostream>
+
+#include <boa/boa.h>
+
+// Bakes images into texture files for boa::load_texture_file
+// Usage: texture_baker [--uncompressed] <image> <output> [<image> <output> ...]
+int main(int argc, char *argv[]) {
+	bool compress = true;
+	int first = 1;
+	if(argc > 1 && std::strcmp(argv[1], "--uncompressed") == 0) {
+		compress = false;
+		++first;
+	}
+
+	if(argc - first < 2 || (argc - first) % 2 != 0) {
+		std::cerr << "Usage: " << argv[0] << " [--uncompressed] <image> <output> [<image> <output> ...]" << std::endl;
+		return 1;
+	}
+
+	int failures = 0;
+	for(int i = first; i < argc; i += 2) {
+		if(boa::bake_texture_file(argv[i], argv[i + 1], compress)) {
+			std::cout << argv[i] << " -> " << argv[i + 1] << std::endl;
+		} else {
+			++failures;
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}